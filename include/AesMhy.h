@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Reference byte-at-a-time implementation (aes.cpp). The schedule is the
+// 176 bytes of round keys.
+void oqs_mhy128_enc_c(const uint8_t* plaintext, const void* schedule, uint8_t* ciphertext);
+void oqs_mhy128_dec_c(const uint8_t* ciphertext, const void* schedule, uint8_t* plaintext);
+
+// Fast backends for the MHY AES-128 variants, bit-identical to the
+// reference. "Encrypt" is the standard cipher run with the inverse tables,
+// which is exactly the AES decryption round (AESDEC). "Decrypt" runs the
+// forward tables in reverse key order; with MixColumns applied to the
+// middle round keys it becomes a plain AESENC chain.
+struct MhyAesKey {
+    alignas(16) uint8_t enc[11][16];  // round keys as given
+    alignas(16) uint8_t dec[11][16];  // rk10, MixColumns(rk9..rk1), rk0
+};
+
+void MhyAesPrepare(const uint8_t roundKeys[176], MhyAesKey& key);
+
+// `blocks` independent 16-byte blocks (ECB); in and out may alias.
+void MhyAesEncrypt(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks);
+void MhyAesDecrypt(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks);
+
+using MhyAesFn = void (*)(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks);
+
+void MhyAesEncrypt_TTable(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks);
+void MhyAesDecrypt_TTable(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks);
+#if defined(SNIFFER_X86_KERNELS)
+void MhyAesEncrypt_AESNI(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks);
+void MhyAesDecrypt_AESNI(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks);
+#endif
+
+// Name of the backend in use ("aesni", "ttable").
+const char* MhyAesBackendName();
+
+// Pin a specific backend (for benchmarks). Returns false if it is unknown
+// or not supported on this CPU.
+bool ForceMhyAesBackend(const char* name);
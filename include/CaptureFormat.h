@@ -0,0 +1,144 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Append-only capture segments.
+//
+//   SegmentHeader (32 bytes)
+//   { RecordHeader (32 bytes) | PacketHead (headLen) | payload (payloadLen) } *
+//
+// All integers are little-endian. Records are packed back to back with no
+// padding, so a segment can be walked with nothing but the record headers.
+
+static constexpr uint8_t kSegmentMagic[8] = { 'E', 'N', 'S', 'C', 'A', 'P', '\r', '\n' };
+static constexpr uint32_t kSegmentVersion = 1;
+static constexpr size_t kSegmentHeaderSize = 32;
+
+static constexpr uint32_t kRecordMagic = 0x31434552; // "REC1"
+static constexpr size_t kRecordHeaderSize = 32;
+
+enum RecordFlags : uint8_t {
+    // Bytes are the undecoded ENet payload (payloadLen = frame). The head is
+    // the raw session head below; captures from before per-peer sessions
+    // have headLen = 0 and number the session by record index.
+    kRecordRaw = 1 << 0,
+    // ProtoScan field index of the payload of the next record (same index
+    // and cmd, same segment): headLen = 0, payload = ProtoField[] as stored
+    // by EncodeProtoIndex. Offsets are relative to that record's payload.
+    kRecordFieldIndex = 1 << 1,
+    // Payload is compressed: it starts with the compressed payload head
+    // below, followed by the codec's output. PacketHead stays plain, so
+    // headLen and the head bytes read the same as in a plain record.
+    kRecordCompressed = 1 << 2,
+};
+
+struct SegmentHeader {
+    uint32_t version = kSegmentVersion;
+    uint32_t recordHeaderSize = uint32_t(kRecordHeaderSize);
+    uint64_t sessionId = 0;
+    uint32_t segmentIndex = 0;
+    uint32_t processId = 0;
+};
+
+struct RecordHeader {
+    uint16_t cmdId = 0;
+    uint8_t direction = 0;     // PacketSource
+    uint8_t flags = 0;         // RecordFlags
+    uint64_t index = 0;        // capture order, 1-based
+    uint64_t timestampNs = 0;  // unix epoch, nanoseconds
+    uint32_t headLen = 0;
+    uint32_t payloadLen = 0;
+
+    size_t BodySize() const { return size_t(headLen) + payloadLen; }
+    size_t RecordSize() const { return kRecordHeaderSize + BodySize(); }
+};
+
+static inline void StoreLE16(uint8_t* p, uint16_t v) { p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); }
+static inline void StoreLE32(uint8_t* p, uint32_t v) { for (int i = 0; i < 4; ++i) p[i] = uint8_t(v >> (8 * i)); }
+static inline void StoreLE64(uint8_t* p, uint64_t v) { for (int i = 0; i < 8; ++i) p[i] = uint8_t(v >> (8 * i)); }
+static inline uint16_t LoadLE16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+static inline uint32_t LoadLE32(const uint8_t* p) {
+    uint32_t v = 0; for (int i = 3; i >= 0; --i) v = (v << 8) | p[i]; return v;
+}
+static inline uint64_t LoadLE64(const uint8_t* p) {
+    uint64_t v = 0; for (int i = 7; i >= 0; --i) v = (v << 8) | p[i]; return v;
+}
+
+static inline void EncodeSegmentHeader(uint8_t* out, const SegmentHeader& h) {
+    for (size_t i = 0; i < 8; ++i) out[i] = kSegmentMagic[i];
+    StoreLE32(out + 8, h.version);
+    StoreLE32(out + 12, h.recordHeaderSize);
+    StoreLE64(out + 16, h.sessionId);
+    StoreLE32(out + 24, h.segmentIndex);
+    StoreLE32(out + 28, h.processId);
+}
+
+static inline bool DecodeSegmentHeader(const uint8_t* in, size_t len, SegmentHeader& h) {
+    if (len < kSegmentHeaderSize) return false;
+    for (size_t i = 0; i < 8; ++i)
+        if (in[i] != kSegmentMagic[i]) return false;
+    h.version = LoadLE32(in + 8);
+    h.recordHeaderSize = LoadLE32(in + 12);
+    h.sessionId = LoadLE64(in + 16);
+    h.segmentIndex = LoadLE32(in + 24);
+    h.processId = LoadLE32(in + 28);
+    return h.version == kSegmentVersion && h.recordHeaderSize >= kRecordHeaderSize;
+}
+
+static inline void EncodeRecordHeader(uint8_t* out, const RecordHeader& r) {
+    StoreLE32(out + 0, kRecordMagic);
+    StoreLE16(out + 4, r.cmdId);
+    out[6] = r.direction;
+    out[7] = r.flags;
+    StoreLE64(out + 8, r.index);
+    StoreLE64(out + 16, r.timestampNs);
+    StoreLE32(out + 24, r.headLen);
+    StoreLE32(out + 28, r.payloadLen);
+}
+
+static inline bool DecodeRecordHeader(const uint8_t* in, size_t len, RecordHeader& r) {
+    if (len < kRecordHeaderSize || LoadLE32(in) != kRecordMagic) return false;
+    r.cmdId = LoadLE16(in + 4);
+    r.direction = in[6];
+    r.flags = in[7];
+    r.index = LoadLE64(in + 8);
+    r.timestampNs = LoadLE64(in + 16);
+    r.headLen = LoadLE32(in + 24);
+    r.payloadLen = LoadLE32(in + 28);
+    return true;
+}
+
+// Head of a raw record: the connection it came from (Session id, unique
+// within the capture session) and its 1-based position in that connection.
+static constexpr size_t kRawSessionHeadSize = 16;
+
+static inline void EncodeRawSessionHead(uint8_t* out, uint64_t sessionId, uint64_t sessionIndex) {
+    StoreLE64(out + 0, sessionId);
+    StoreLE64(out + 8, sessionIndex);
+}
+
+static inline bool DecodeRawSessionHead(const uint8_t* in, size_t len, uint64_t& sessionId, uint64_t& sessionIndex) {
+    if (len < kRawSessionHeadSize) return false;
+    sessionId = LoadLE64(in + 0);
+    sessionIndex = LoadLE64(in + 8);
+    return true;
+}
+
+// Head of a compressed payload: codec (Compression.h), dictionary id (0 if
+// none) and the plain payload length.
+static constexpr size_t kCompressedPayloadHeadSize = 12;
+
+static inline void EncodeCompressedPayloadHead(uint8_t* out, uint8_t codec, uint32_t dictId, uint32_t plainLen) {
+    out[0] = codec;
+    out[1] = out[2] = out[3] = 0;
+    StoreLE32(out + 4, dictId);
+    StoreLE32(out + 8, plainLen);
+}
+
+static inline bool DecodeCompressedPayloadHead(const uint8_t* in, size_t len, uint8_t& codec, uint32_t& dictId, uint32_t& plainLen) {
+    if (len < kCompressedPayloadHeadSize) return false;
+    codec = in[0];
+    dictId = LoadLE32(in + 4);
+    plainLen = LoadLE32(in + 8);
+    return true;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "CaptureFormat.h"
+#include "PacketBuffer.h"
+#include "PacketDecoder.h"
+#include "Platform.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+class DictionarySet;
+
+// One record as stored; pointers refer into the mapped segment.
+struct RecordView {
+    RecordHeader hdr;
+    const uint8_t* head = nullptr;
+    const uint8_t* payload = nullptr;
+    // Stored ProtoScan index of the payload (DecodeProtoField), if any.
+    const uint8_t* fieldIndex = nullptr;
+    uint32_t fieldCount = 0;
+    // ENet session of a record decoded from raw; 0 for stored decodes.
+    uint64_t peerSession = 0;
+};
+
+// Memory-mapped, forward-only walk over one capture segment. Records are
+// returned as views into the mapping; nothing is copied or allocated.
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    ~CaptureReader() { Close(); }
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    // False at the end of the segment or at the first truncated/corrupt
+    // record (see Truncated()).
+    bool Next(RecordView& out);
+
+    const SegmentHeader& Segment() const { return seg_; }
+    bool Truncated() const { return truncated_; }
+
+private:
+    Platform::MappedFile map_;
+    SegmentHeader seg_;
+    size_t pos_ = 0;
+    bool truncated_ = false;
+};
+
+// Capture segment files under `path` (or `path` itself), in session and
+// segment order.
+std::vector<std::filesystem::path> ListCaptureSegments(const std::filesystem::path& path);
+
+struct ReplayStats {
+    uint64_t records = 0;        // records read from disk
+    uint64_t rawRecords = 0;     // of which undecoded frames
+    uint64_t indexRecords = 0;   // of which field indexes
+    uint64_t decoded = 0;        // raw frames decoded successfully
+    uint64_t frameErrors = 0;    // raw frames rejected by the decoder
+    uint64_t bytes = 0;          // segment bytes walked
+    uint64_t truncatedSegments = 0;
+    uint64_t compressedRecords = 0;  // decoded records stored compressed
+    uint64_t inflateErrors = 0;      // of which could not be inflated (skipped)
+};
+
+// Replays capture segments through PacketDecoder, the same pipeline the
+// hooks run live. Raw records are re-decoded (with one decoder per
+// connection, reset with each capture session)
+// and replace the decoded record the sniffer stored next to them; decoded
+// records without a raw twin are passed through. Field index records are
+// attached to the record they describe rather than returned; re-decoded
+// records carry none. Compressed records are inflated, with the
+// dictionaries given to SetDictionaries if they were compressed with one.
+// The views handed out stay valid until the next call; decoded and
+// inflated bytes live in recycled slabs.
+class ReplaySource {
+public:
+    explicit ReplaySource(std::vector<std::filesystem::path> segments)
+        : segments_(std::move(segments)) {}
+
+    bool Next(RecordView& out);
+
+    void SetDictionaries(const DictionarySet* dicts) { dicts_ = dicts; }
+
+    const ReplayStats& Stats() const { return stats_; }
+
+private:
+    bool NextStored(RecordView& out);
+
+    std::vector<std::filesystem::path> segments_;
+    size_t nextSegment_ = 0;
+    CaptureReader reader_;
+    bool readerOpen_ = false;
+
+    uint64_t sessionId_ = ~0ull;
+    std::unordered_map<uint64_t, PacketDecoder> decoders_;  // by raw session id
+    PacketBuffer decoded_;
+    PacketBuffer inflated_;
+    const DictionarySet* dicts_ = nullptr;
+    uint64_t lastRawIndex_ = 0;
+    RecordView pendingIndex_;  // index record waiting for its payload record
+    ReplayStats stats_;
+};
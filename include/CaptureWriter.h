@@ -0,0 +1,49 @@
+#pragma once
+#include "CaptureFormat.h"
+#include "Platform.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Appends encoded records to rotating segment files
+// <dir>/<prefix>_<segment>.enscap. Not thread-safe; owned by the writer.
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter() { Close(); }
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    bool Open(const std::filesystem::path& dir, uint64_t sessionId, uint64_t maxSegmentBytes);
+
+    // `record` is a full record (RecordHeader + body) of `len` bytes.
+    bool Append(const uint8_t* record, size_t len);
+
+    // Group commit: each slice is one full record. Written with one gathered
+    // write per segment touched.
+    bool AppendBatch(const Platform::IoSlice* records, size_t count);
+
+    void Close();
+
+    bool IsOpen() const { return fh_ != Platform::kInvalidFile; }
+    uint64_t RecordsWritten() const { return records_; }
+
+    static std::filesystem::path SegmentPath(const std::filesystem::path& dir, uint64_t sessionId, uint32_t segment);
+
+private:
+    bool OpenSegment();
+    bool Rotate();
+
+    std::filesystem::path dir_;
+    uint64_t sessionId_ = 0;
+    uint64_t maxSegmentBytes_ = 0;
+    uint32_t segmentIndex_ = 0;
+    uint64_t segmentBytes_ = 0;
+    uint64_t records_ = 0;
+    Platform::FileHandle fh_ = Platform::kInvalidFile;
+};
+
+// Legacy export layout: one <index>_<CS|SC>_<Name>.bin per packet holding
+// just the decoded payload.
+bool WriteLegacyPacketFile(const std::filesystem::path& dir, const RecordHeader& rec, const uint8_t* payload);
@@ -0,0 +1,89 @@
+#pragma once
+#include "PacketProcessor.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// First-N sampling counts of one session, kept with the session and reset
+// whenever a different filter is in use.
+struct SessionSamples {
+    uint64_t filterId = 0;
+    std::vector<uint32_t> seen;  // by sample slot
+};
+
+// Which packets are captured: one bit per cmd id and direction, compiled
+// from a rule file, plus optional per-cmd sampling. The sequencer checks it
+// right after the header is decrypted; packets that don't pass are counted
+// and dropped before their payload is decrypted or written.
+//
+// Rule file, one rule per line, '#' starts a comment:
+//
+//   allow SceneEntityAppearNotify, PlayerLoginRsp
+//   deny  SC:PingRsp, 4
+//   sample SceneEntityMoveNotify every 50
+//   sample EvtAiSyncSkillCdNotify rate 20/5
+//   sample PlayerPropNotify first 10
+//
+// Each rule takes comma separated cmd names or ids, optionally prefixed
+// with CS: (client to server) or SC: (server to client). Without allow
+// rules everything passes except what is denied; with them only what is
+// allowed and not denied passes. Sampling then keeps every Nth packet of a
+// cmd, at most N per second (token bucket, burst B, default N), or the
+// first N of each session; a later sample rule for a cmd replaces an
+// earlier one.
+class CmdFilter {
+public:
+    CmdFilter();  // passes everything
+
+    // Bad lines are reported and skipped. False if the file can't be read.
+    bool Load(const std::filesystem::path& path);
+    bool ParseLine(const std::string& line);
+
+    bool Pass(uint16_t cmdId, PacketSource src) const {
+        return (Bits(src)[cmdId >> 6] >> (cmdId & 63)) & 1;
+    }
+
+    // Sampling verdict for a packet that passed. Updates the sampling state,
+    // so only the sequencer calls it, in capture order.
+    bool Sample(uint16_t cmdId, PacketSource src, uint64_t timestampNs, SessionSamples& session) {
+        if (slotOf_.empty()) return true;
+        const uint32_t slot = slotOf_[size_t(src) << 16 | cmdId];
+        return slot == 0 || Keep(slot - 1, timestampNs, session);
+    }
+
+    // Cmd ids that pass in `src`, and (cmd id, direction) pairs sampled.
+    size_t Passing(PacketSource src) const;
+    size_t Sampled() const { return samples_.size(); }
+
+private:
+    static constexpr size_t kWords = (size_t(UINT16_MAX) + 1) / 64;
+
+    enum class SampleMode : uint8_t { Every, Rate, First };
+
+    struct Sampler {
+        SampleMode mode = SampleMode::Every;
+        uint32_t n = 1;       // every n-th, n per second, first n
+        uint32_t burst = 1;   // Rate: bucket size
+        uint64_t count = 0;   // Every: packets seen
+        double tokens = 0;    // Rate: bucket level
+        uint64_t lastNs = 0;  // Rate: last refill
+    };
+
+    const uint64_t* Bits(PacketSource src) const { return bits_[size_t(src)]; }
+    static size_t ParseCmds(const std::string& list, uint64_t (*out)[kWords]);
+    void Compile();
+    bool ParseSample(const std::string& rest);
+    bool Keep(uint32_t slot, uint64_t timestampNs, SessionSamples& session);
+
+    uint64_t bits_[2][kWords];
+    uint64_t allow_[2][kWords];
+    uint64_t deny_[2][kWords];
+    bool anyAllow_ = false;
+
+    const uint64_t id_;                  // tells sessions a new filter is in use
+    std::vector<uint32_t> slotOf_;       // direction << 16 | cmd -> slot + 1; empty without sampling
+    std::vector<Sampler> samples_;
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include "CaptureFormat.h"
+#include "Lz4.h"
+#include "PacketBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class Codec : uint8_t {
+    None = 0,
+    Lz4 = 1,   // built in, fast enough for the live writer
+    Zstd = 2,  // archival; only with SNIFFER_HAVE_ZSTD
+};
+
+const char* CodecName(Codec c);
+bool ParseCodec(const std::string& name, Codec& out);
+bool CodecAvailable(Codec c);
+
+// Raw-content dictionary for the payloads of one cmd: history the codec
+// can match against, so records of a few hundred bytes still compress.
+struct CmdDictionary {
+    uint16_t cmdId = 0;
+    uint32_t id = 0;  // content hash, stored in every record compressed with it
+    std::vector<uint8_t> bytes;
+    Lz4Dict lz4;
+    std::shared_ptr<void> zstdC;  // ZSTD_CDict
+    std::shared_ptr<void> zstdD;  // ZSTD_DDict
+};
+
+// Per-cmd dictionaries as trained by `sniffer_replay --train-dicts`.
+// Read-only once prepared; shared by all compressing threads.
+class DictionarySet {
+public:
+    DictionarySet();
+
+    bool Load(const std::filesystem::path& path);
+    bool Save(const std::filesystem::path& path) const;
+
+    void Add(uint16_t cmdId, std::vector<uint8_t> bytes);
+    // Builds the codec state; call once after Load/Add, before use.
+    void Prepare(int zstdLevel);
+
+    const CmdDictionary* ForCmd(uint16_t cmdId) const;
+    const CmdDictionary* ById(uint32_t id) const;
+    size_t Size() const { return dicts_.size(); }
+
+private:
+    std::vector<std::unique_ptr<CmdDictionary>> dicts_;
+    std::vector<int32_t> byCmd_;  // cmd id -> index in dicts_, -1 if none
+};
+
+// Collects payload samples per cmd and turns the busiest cmds into
+// dictionaries of up to `dictBytes` each.
+class DictionaryTrainer {
+public:
+    explicit DictionaryTrainer(size_t dictBytes = 16 * 1024, size_t maxDicts = 256)
+        : dictBytes_(dictBytes), maxDicts_(maxDicts) {}
+
+    void Add(uint16_t cmdId, const uint8_t* payload, size_t len);
+    void Build(DictionarySet& out) const;
+
+private:
+    struct Samples {
+        uint64_t seen = 0;        // samples offered
+        uint64_t seenBytes = 0;
+        std::vector<std::vector<uint8_t>> kept;
+        size_t keptBytes = 0;
+    };
+
+    size_t dictBytes_;
+    size_t maxDicts_;
+    uint64_t rng_ = 0x9E3779B97F4A7C15ull;
+    std::vector<Samples> byCmd_;
+};
+
+struct CompressionOptions {
+    Codec codec = Codec::None;
+    int level = 3;                        // zstd only
+    uint32_t minBytes = 64;               // smaller payloads are stored as is
+    const DictionarySet* dicts = nullptr;
+};
+
+// Compresses the payload of an encoded record (RecordHeader + PacketHead +
+// payload) into a kRecordCompressed record in `out`. False if the record is
+// better kept as is (too small, incompressible, codec unavailable).
+bool CompressRecord(const uint8_t* record, const CompressionOptions& opt, PacketBuffer& out);
+
+// Inflates the payload of a kRecordCompressed record (`body` = PacketHead +
+// stored payload) into `out`, which receives rec.payloadLen of the plain
+// record. `rec` is updated to describe the plain record.
+bool DecompressPayload(RecordHeader& rec, const uint8_t* body, const DictionarySet* dicts, PacketBuffer& out);
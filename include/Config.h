@@ -0,0 +1,51 @@
+#pragma once
+#include "Compression.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+enum class OutputMode : uint8_t {
+    Segments,   // packed append-only capture segments (CaptureFormat.h)
+    PerFile,    // legacy <idx>_<CS|SC>_<Name>.bin, one file per packet
+};
+
+// What the hooks do once in-flight packets exceed memory_budget.
+enum class OverflowPolicy : uint8_t {
+    Block,            // wait for the writer (lossless, may stall the game)
+    DropNewest,       // drop the packet being captured
+    DropOldest,       // drop the longest-waiting undecoded packets
+    DropLowPriority,  // drop low_priority_cmds packets, wait otherwise
+};
+
+struct SnifferConfig {
+    OutputMode outputMode = OutputMode::Segments;
+    std::filesystem::path outputDir = "RawPackets";  // relative to the base dir
+    uint64_t segmentBytes = 256ull << 20;            // rotate segments at this size
+    bool captureRaw = false;                         // also store undecoded frames
+    bool indexFields = false;                        // store a ProtoScan field index with each payload
+    bool trackRtt = true;                            // pair requests with responses, per-cmd RTT
+    uint64_t flushBytes = 1ull << 20;                // group commit: flush at this many bytes...
+    uint32_t flushMs = 5;                            // ...or when the oldest record is this old
+    uint32_t decodeThreads = 2;                      // payload decrypt/index workers behind the hooks
+    uint64_t memoryBudget = 256ull << 20;            // in-flight packet bytes, hook to disk
+    OverflowPolicy overflowPolicy = OverflowPolicy::DropNewest;
+    std::vector<uint16_t> lowPriorityCmds;           // shed first under DropLowPriority
+    Codec compression = Codec::None;                 // per-record payload compression in segments
+    int compressionLevel = 3;                        // zstd level
+    uint32_t compressMinBytes = 64;                  // smaller payloads are stored as is
+    std::filesystem::path compressionDicts;          // per-cmd dictionaries (relative to the base dir)
+    std::filesystem::path cmdFilter;                 // allow/deny rules (CmdFilter.h, relative to the base dir)
+    uint32_t keyCacheSize = 64;                      // derived session keys kept in memory
+    std::filesystem::path keyCacheFile;              // persist derived keys here (relative to the base dir)
+    std::filesystem::path ec2bCache;                 // ec2b pad cache from ec2b_bulk (relative to the base dir)
+    uint64_t ec2bId = 0;                             // blob hash to use from ec2bCache
+};
+
+// `key = value` lines, '#' or ';' starts a comment. Unknown keys and bad
+// values are reported and skipped. Returns false if the file can't be read.
+bool LoadConfigFile(const std::filesystem::path& path, SnifferConfig& cfg);
+
+// EnetSniffer.ini next to the host executable, loaded on first use.
+const SnifferConfig& GetConfig();
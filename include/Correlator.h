@@ -0,0 +1,105 @@
+#pragma once
+#include "CaptureFormat.h"
+#include "PacketHead.h"
+#include "Telemetry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct CorrelatorStats {
+    uint64_t requests = 0;       // client packets with a known response id
+    uint64_t responses = 0;      // server packets with a known request id
+    uint64_t matchedBySeq = 0;   // paired on client_sequence_id
+    uint64_t matchedByCmd = 0;   // paired on the Req/Rsp id only
+    uint64_t unmatched = 0;      // response without an outstanding request
+    uint64_t duplicates = 0;     // second response to an answered request
+    uint64_t reordered = 0;      // response to an older request than the last one answered
+    uint64_t lost = 0;           // requests never answered (timed out or replaced)
+    uint64_t pending = 0;        // requests still waiting
+    uint64_t seqGaps = 0;        // client sequence ids skipped
+    uint64_t seqDuplicates = 0;  // client sequence id repeated
+    uint64_t seqReordered = 0;   // client sequence id older than the last one
+};
+
+// Pairs client requests with server responses and keeps a round-trip
+// histogram per request cmd. Each session (ENet connection) is paired on
+// its own. Responses are matched on the client sequence id they echo.
+// Otherwise they pair with the latest request of the matching cmd, so there
+// is one outstanding request per cmd (per session) on that path.
+// Outstanding requests live in a fixed open-addressing table, so nothing is
+// allocated per packet (only once per cmd for its histogram).
+//
+// Feed decoded packets in capture order. Safe to read from another thread
+// while one thread feeds it.
+class Correlator {
+public:
+    // `slots` is rounded up to a power of two.
+    explicit Correlator(size_t slots = 4096, uint64_t timeoutNs = 60ull * 1000000000ull);
+
+    void Observe(const RecordHeader& rec, const uint8_t* head, uint64_t session = 0);
+    void Observe(const RecordHeader& rec, const PacketHead& head, uint64_t session = 0);
+
+    // A session ended (reconnect or peer reset): its outstanding requests
+    // count as lost and its sequence state is dropped.
+    void EndSession(uint64_t session);
+
+    CorrelatorStats Stats() const;
+
+    struct CmdRtt {
+        uint16_t reqCmd = 0;
+        uint64_t count = 0;
+        double p50Ms = 0, p99Ms = 0, maxMs = 0;
+    };
+    // Per request cmd, most frequent first.
+    std::vector<CmdRtt> Rtts() const;
+
+    // Counters and the `maxCmds` busiest cmds.
+    void Report(FILE* out, size_t maxCmds = 20) const;
+
+private:
+    enum class SlotState : uint8_t { Empty, Pending, Answered };
+    struct Slot {
+        uint64_t session = 0;
+        uint64_t key = 0;
+        uint64_t sentNs = 0;
+        uint32_t seq = 0;
+        uint16_t reqCmd = 0;
+        SlotState state = SlotState::Empty;
+    };
+
+    // Per-session sequence high-water marks.
+    struct SeqMarks {
+        uint32_t lastClientSeq = 0;
+        uint32_t lastAnsweredSeq = 0;
+    };
+    struct LatestSeq {
+        uint64_t session = 0;
+        uint32_t seq = 0;
+    };
+
+    Slot* Find(uint64_t session, uint64_t key);
+    Slot* Insert(uint64_t session, uint64_t key);
+    void Sweep(uint64_t nowNs);
+    SeqMarks& Marks(uint64_t session);
+    void OnRequest(const RecordHeader& rec, uint64_t session, uint32_t seq);
+    void OnResponse(const RecordHeader& rec, uint64_t session, uint16_t reqCmd, uint32_t seq);
+    void OnClientSeq(SeqMarks& m, uint32_t seq);
+
+    mutable std::mutex lock_;
+    std::vector<Slot> slots_;
+    std::vector<Slot> scratch_;
+    size_t mask_ = 0;
+    size_t used_ = 0;
+    uint64_t timeoutNs_;
+    std::unordered_map<uint64_t, SeqMarks> marks_;  // by session, one allocation per session
+    uint64_t marksSession_ = ~0ull;                 // cache of the last lookup
+    SeqMarks* marksCache_ = nullptr;
+    CorrelatorStats stats_;
+    std::vector<LatestSeq> lastSeqByCmd_;                     // latest sequence id per request cmd
+    std::vector<std::unique_ptr<Telemetry::Histogram>> rtt_;  // by request cmd
+};
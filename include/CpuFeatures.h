@@ -0,0 +1,17 @@
+#pragma once
+
+// x86 instruction set extensions usable by this process (CPU support and,
+// for AVX/AVX-512, OS support for the wider register state). Everything is
+// false on non-x86 builds.
+struct CpuFeatures {
+    bool sse2 = false;
+    bool ssse3 = false;
+    bool sse41 = false;
+    bool aesni = false;
+    bool avx2 = false;
+    bool bmi2 = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+};
+
+const CpuFeatures& GetCpuFeatures();
@@ -0,0 +1,51 @@
+#pragma once
+#include "ec2b_global.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Content-addressed store of derived ec2b xorpads, keyed by the FNV-1a 64
+// hash of the raw 2076-byte blob. Lets one sniffer build handle every
+// client build we track instead of only the compiled-in key.
+uint64_t Ec2bBlobHash(const uint8_t* blob, size_t len);
+
+// Accepts a raw blob or its base64 text. Returns false if the result is not
+// a kEc2bBlobSize-byte "Ec2b" blob.
+bool ParseEc2bBlob(const uint8_t* data, size_t len, std::vector<uint8_t>& blob);
+
+class Ec2bPadCache {
+public:
+    // A missing file is an empty cache; a corrupt one fails.
+    bool Load(const std::filesystem::path& path);
+    bool Save(const std::filesystem::path& path) const;
+
+    const Ec2bXorpad* Find(uint64_t hash) const;
+    void Insert(uint64_t hash, const Ec2bXorpad& pad);
+    size_t Size() const { return pads_.size(); }
+    const std::unordered_map<uint64_t, Ec2bXorpad>& Entries() const { return pads_; }
+
+private:
+    std::unordered_map<uint64_t, Ec2bXorpad> pads_;
+};
+
+struct Ec2bJob {
+    std::string name;           // for reporting only
+    std::vector<uint8_t> blob;  // raw blob
+    uint64_t hash = 0;
+    bool cached = false;        // pad was already in the cache
+    bool ok = false;
+};
+
+// Derives the pad of every job not yet in `cache` on `threads` workers
+// (0 = hardware concurrency) and inserts the results. Returns the number
+// of newly derived pads.
+size_t DeriveEc2bPads(std::vector<Ec2bJob>& jobs, Ec2bPadCache& cache, unsigned threads);
+
+// Pad for the token exchange: the ec2b_id entry of ec2b_cache from
+// EnetSniffer.ini (or its only entry when no id is given), otherwise the
+// built-in pad. Resolved once, on first use.
+const Ec2bXorpad& GetEc2bXorpad();
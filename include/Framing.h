@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Wire frame: BE16 magic 0x4567 | BE16 cmdId | BE16 headLen | BE32 payloadLen
+//             | PacketHead (headLen) | payload (payloadLen) | BE16 0x89AB
+static constexpr uint16_t kFrameMagic = 0x4567;
+static constexpr uint16_t kFrameTrailer = 0x89AB;
+static constexpr size_t kFrameHeaderSize = 10;
+static constexpr size_t kFrameTrailerSize = 2;
+
+static inline uint16_t ReadBE16(const uint8_t* p) {
+    return (uint16_t(p[0]) << 8) | uint16_t(p[1]);
+}
+static inline uint32_t ReadBE32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+// The XOR layers in effect for one packet. Either pad may be null; both
+// repeat from offset 0 at the start of every packet.
+struct Keystream {
+    const uint8_t* ec2b = nullptr;
+    size_t ec2bLen = 0;
+    const uint8_t* key = nullptr;
+    size_t keyLen = 0;
+
+    bool empty() const { return !ec2b && !key; }
+};
+
+struct FrameHeader {
+    uint16_t cmdId = 0;
+    uint16_t headLen = 0;
+    uint32_t payloadLen = 0;
+
+    size_t HeadOffset() const { return kFrameHeaderSize; }
+    size_t PayloadOffset() const { return kFrameHeaderSize + headLen; }
+    size_t FrameSize() const { return kFrameHeaderSize + size_t(headLen) + payloadLen + kFrameTrailerSize; }
+};
+
+enum class FrameStatus : uint8_t {
+    Ok,
+    TooShort,
+    BadMagic,
+    BadLength,
+    BadTrailer,
+};
+
+// Stage 1: decrypt only the fixed header and the trailer of `raw` and
+// validate them. Touches 12 bytes regardless of packet size.
+FrameStatus DecodeFrameHeader(const uint8_t* raw, size_t len, const Keystream& ks, FrameHeader& out);
+
+// Stage 2: decrypt `len` bytes of `raw` starting at frame offset `offset`
+// into `dst` (which may alias raw + offset).
+void DecodeFrameRegion(uint8_t* dst, const uint8_t* raw, size_t offset, size_t len, const Keystream& ks);
@@ -0,0 +1,6 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+std::string to_hex(const uint8_t* data, size_t len, bool with_ascii = false);
@@ -0,0 +1,64 @@
+#pragma once
+#include "SessionKey.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Immutable derived session key. Shared between the cache and every
+// decoder using it, so installing a key is a pointer swap.
+struct DerivedKey {
+    uint64_t seed = 0;
+    alignas(64) uint8_t bytes[kSessionKeySize];
+};
+using KeyPtr = std::shared_ptr<const DerivedKey>;
+
+struct KeyCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+};
+
+// Bounded LRU of derived keys keyed by seed. Reconnects reuse the same
+// seeds, so most token responses become a lookup instead of an MT64 run.
+// Optionally backed by an append-only file so replay and later sessions
+// start warm.
+class KeyCache {
+public:
+    explicit KeyCache(size_t capacity) : capacity_(capacity ? capacity : 1) {}
+
+    // Returns the key for `seed`, deriving (and persisting) it on a miss.
+    KeyPtr Get(uint64_t seed);
+
+    // Loads keys saved earlier and appends new keys to `path` from now on.
+    // A missing file is not an error; a file with more than `capacity`
+    // entries is compacted.
+    bool Attach(const std::filesystem::path& path);
+
+    size_t Size() const;
+    KeyCacheStats Stats() const;
+
+private:
+    struct Entry {
+        KeyPtr key;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    void InsertLocked(KeyPtr key);
+    bool RewriteLocked();
+
+    const size_t capacity_;
+    mutable std::mutex lock_;
+    std::list<uint64_t> lru_;   // most recent first
+    std::unordered_map<uint64_t, Entry> map_;
+    std::filesystem::path file_;
+    KeyCacheStats stats_;
+};
+
+// Process-wide cache sized by key_cache_size and attached to
+// key_cache_file (if set) from EnetSniffer.ini.
+KeyCache& GetKeyCache();
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// LZ4 block format (no frame): compatible with LZ4_compress_fast and
+// LZ4_decompress_safe_usingDict. A dictionary acts as history in front of
+// the input, so small records of the same kind compress against it.
+
+static constexpr size_t kLz4MaxDict = 64 * 1024;  // farthest reachable offset
+static constexpr int kLz4HashLog = 12;
+
+// Dictionary prepared once and shared read-only between threads.
+struct Lz4Dict {
+    std::vector<uint8_t> bytes;   // last kLz4MaxDict bytes of the source
+    std::vector<uint32_t> table;  // 1 << kLz4HashLog positions in `bytes`, +1 (0 = empty)
+};
+
+void Lz4PrepareDict(const uint8_t* data, size_t len, Lz4Dict& out);
+
+// Worst-case compressed size of `n` bytes.
+static inline size_t Lz4CompressBound(size_t n) { return n + n / 255 + 16; }
+
+// Returns the compressed size, or 0 if it doesn't fit in `cap`.
+size_t Lz4Compress(const uint8_t* src, size_t n, uint8_t* dst, size_t cap, const Lz4Dict* dict = nullptr);
+
+// Decompresses exactly `outLen` bytes. False on malformed input, on
+// anything that would read or write out of bounds, or on a size mismatch.
+bool Lz4Decompress(const uint8_t* src, size_t n, uint8_t* dst, size_t outLen,
+    const uint8_t* dict = nullptr, size_t dictLen = 0);
@@ -0,0 +1,66 @@
+#pragma once
+#include "Config.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+enum class DropReason : uint8_t {
+    Newest,       // refused at capture
+    Oldest,       // shed by the sequencer before decoding
+    LowPriority,  // low_priority_cmds shed by the sequencer
+    Count
+};
+
+struct OverflowStats {
+    uint64_t inFlight = 0;  // bytes
+    uint64_t peak = 0;      // bytes
+    uint64_t dropped[size_t(DropReason::Count)] = {};
+    uint64_t droppedBytes[size_t(DropReason::Count)] = {};
+    uint64_t blocked = 0;    // captures that waited for room
+    uint64_t blockedNs = 0;  // total time they waited
+};
+
+// Byte budget for packets between the hooks and the disk. A frame is
+// charged when the hooks copy it and credited once the writer has released
+// everything made from it, so the count covers every queue in between.
+class MemoryBudget {
+public:
+    // Set before the first charge.
+    void SetLimit(uint64_t limit) { limit_ = limit; }
+
+    // False if `bytes` would go over the limit. A frame larger than the
+    // whole budget still gets in when nothing else is in flight.
+    bool TryCharge(uint64_t bytes);
+    // Charges past the limit (packets that must never be dropped).
+    void ChargeAnyway(uint64_t bytes);
+    // Waits until `bytes` fit; `poke` (may be null) runs before each wait
+    // to wake a stage that can free memory.
+    void WaitCharge(uint64_t bytes, void (*poke)());
+    void Credit(uint64_t bytes);
+
+    uint64_t InFlight() const { return inFlight_.load(std::memory_order_relaxed); }
+    uint64_t Limit() const { return limit_; }
+
+    void Dropped(DropReason r, uint64_t bytes);
+
+    OverflowStats Stats() const;
+    void Report(FILE* out, OverflowPolicy policy) const;
+
+private:
+    void NotePeak(uint64_t now);
+
+    uint64_t limit_ = UINT64_MAX;
+    std::atomic<uint64_t> inFlight_{ 0 };
+    std::atomic<uint64_t> peak_{ 0 };
+    std::atomic<uint64_t> dropped_[size_t(DropReason::Count)] = {};
+    std::atomic<uint64_t> droppedBytes_[size_t(DropReason::Count)] = {};
+    std::atomic<uint64_t> blocked_{ 0 };
+    std::atomic<uint64_t> blockedNs_{ 0 };
+
+    std::atomic<uint32_t> waiters_{ 0 };
+    std::mutex m_;
+    std::condition_variable cv_;
+};
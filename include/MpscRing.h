@@ -0,0 +1,137 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// Bounded lock-free multi-producer / single-consumer ring of pre-allocated
+// slots (Vyukov sequence-per-slot scheme). A push is one CAS on the tail
+// plus a release store; there is no lock and no allocation. Capacity is
+// rounded up to a power of two.
+template <typename T>
+class MpscRing {
+public:
+    explicit MpscRing(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        slots_.reset(new Slot[cap]);
+        for (size_t i = 0; i < cap; ++i) slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Producers. Returns false if the ring is full; `v` is left untouched.
+    bool TryPush(T& v) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            const size_t seq = slot->seq.load(std::memory_order_acquire);
+            const intptr_t diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(v);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only.
+    bool TryPop(T& out) {
+        Slot* slot = &slots_[head_ & mask_];
+        if (slot->seq.load(std::memory_order_acquire) != head_ + 1) return false;
+        out = std::move(slot->value);
+        slot->seq.store(head_ + mask_ + 1, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+    // Consumer only.
+    bool Empty() const {
+        const Slot* slot = &slots_[head_ & mask_];
+        return slot->seq.load(std::memory_order_acquire) != head_ + 1;
+    }
+
+    size_t Capacity() const { return mask_ + 1; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq{ 0 };
+        T value{};
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> tail_{ 0 };
+    alignas(64) size_t head_ = 0;
+};
+
+// Lets a single consumer sleep when its queue runs dry. Producers only touch
+// the event when the consumer has actually parked, so the common-case cost
+// of Notify() is one fence and one load.
+class ConsumerParker {
+public:
+    // Producer side, call after publishing work.
+    void Notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked_.load(std::memory_order_relaxed) && parked_.exchange(false)) {
+            std::lock_guard<std::mutex> lk(m_);
+            cv_.notify_one();
+        }
+    }
+
+    // Consumer side. `hasWork` is re-checked after announcing the park so a
+    // push racing with the decision to sleep is never missed.
+    template <typename Pred>
+    void Park(Pred hasWork) {
+        if (!Announce(hasWork)) return;
+        std::unique_lock<std::mutex> lk(m_);
+        cv_.wait(lk, [&] { return !parked_.load(std::memory_order_relaxed); });
+    }
+
+    // As Park, but gives up after `timeout` (e.g. a pending flush deadline).
+    template <typename Pred, typename Rep, typename Period>
+    void ParkFor(Pred hasWork, std::chrono::duration<Rep, Period> timeout) {
+        if (!Announce(hasWork)) return;
+        std::unique_lock<std::mutex> lk(m_);
+        cv_.wait_for(lk, timeout, [&] { return !parked_.load(std::memory_order_relaxed); });
+        parked_.store(false, std::memory_order_relaxed);
+    }
+
+    // Unconditional wake, e.g. for shutdown.
+    void Wake() {
+        parked_.store(false);
+        std::lock_guard<std::mutex> lk(m_);
+        cv_.notify_all();
+    }
+
+private:
+    template <typename Pred>
+    bool Announce(Pred& hasWork) {
+        parked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (hasWork()) {
+            parked_.store(false, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    std::atomic<bool> parked_{ false };
+    std::mutex m_;
+    std::condition_variable cv_;
+};
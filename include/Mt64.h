@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+enum class Endian : uint8_t { Little, Big };
+
+// MT19937-64, bit-identical to std::mt19937_64. Used for both the session
+// key (big-endian output) and the ec2b xorpad (little-endian output). Bulk
+// output goes through Fill, which twists and tempers a whole 312-word block
+// at a time with the widest kernel the CPU supports.
+class Mt64 {
+public:
+    static constexpr size_t kStateWords = 312;
+
+    explicit Mt64(uint64_t seed = 5489ULL) { Seed(seed); }
+
+    void Seed(uint64_t seed);
+    uint64_t Next();
+
+    // Writes `len` bytes of output, each 64-bit word in `endian` byte order.
+    // A trailing partial word consumes a whole output.
+    void Fill(uint8_t* out, size_t len, Endian endian);
+
+private:
+    alignas(64) uint64_t mt_[kStateWords];
+    size_t idx_;
+};
+
+// Block kernels: Twist regenerates the state in place, Temper writes
+// `words` tempered outputs of `mt` to `out`.
+struct Mt64Kernel {
+    const char* name;
+    void (*twist)(uint64_t* mt);
+    void (*temper)(const uint64_t* mt, uint8_t* out, size_t words, Endian endian);
+};
+
+void Mt64Twist_Scalar(uint64_t* mt);
+void Mt64Temper_Scalar(const uint64_t* mt, uint8_t* out, size_t words, Endian endian);
+#if defined(SNIFFER_X86_KERNELS)
+void Mt64Twist_AVX2(uint64_t* mt);
+void Mt64Temper_AVX2(const uint64_t* mt, uint8_t* out, size_t words, Endian endian);
+#endif
+
+// Name of the kernel in use ("scalar", "avx2").
+const char* Mt64KernelName();
+
+// Pin a specific kernel (for benchmarks). Returns false if it is unknown or
+// not supported on this CPU.
+bool ForceMt64Kernel(const char* name);
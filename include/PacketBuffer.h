@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+struct PacketSlab;
+
+// Move-only handle to a pooled, size-classed slab holding one packet.
+// The hook copies the ENet payload into a slab once; every later stage
+// decrypts and parses in place and narrows the visible window instead of
+// copying. Destroying the handle returns the slab to its size class.
+class PacketBuffer {
+public:
+    PacketBuffer() = default;
+    ~PacketBuffer() { Release(); }
+
+    PacketBuffer(PacketBuffer&& o) noexcept
+        : slab_(o.slab_), data_(o.data_), len_(o.len_) {
+        o.slab_ = nullptr; o.data_ = nullptr; o.len_ = 0;
+    }
+    PacketBuffer& operator=(PacketBuffer&& o) noexcept {
+        if (this != &o) {
+            Release();
+            slab_ = o.slab_; data_ = o.data_; len_ = o.len_;
+            o.slab_ = nullptr; o.data_ = nullptr; o.len_ = 0;
+        }
+        return *this;
+    }
+    PacketBuffer(const PacketBuffer&) = delete;
+    PacketBuffer& operator=(const PacketBuffer&) = delete;
+
+    // Returns a buffer of exactly `size` visible bytes (contents undefined).
+    static PacketBuffer Acquire(size_t size);
+
+    // Acquire + single copy of `len` bytes from `src`.
+    static PacketBuffer CopyFrom(const void* src, size_t len);
+
+    uint8_t* data() const { return data_; }
+    size_t size() const { return len_; }
+    bool empty() const { return len_ == 0; }
+    explicit operator bool() const { return slab_ != nullptr; }
+
+    // Narrow the visible window to [offset, offset + len) of the current one.
+    void Trim(size_t offset, size_t len) {
+        data_ += offset;
+        len_ = len;
+    }
+
+    void Release();
+
+private:
+    PacketSlab* slab_ = nullptr;
+    uint8_t* data_ = nullptr;
+    size_t len_ = 0;
+};
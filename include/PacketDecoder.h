@@ -0,0 +1,65 @@
+#pragma once
+#include "CaptureFormat.h"
+#include "Framing.h"
+#include "KeyCache.h"
+#include "PacketBuffer.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+static constexpr uint16_t GET_PLAYER_TOKEN_REQ = 101;
+static constexpr uint16_t GET_PLAYER_TOKEN_RSP = 102;
+
+struct DecodeResult {
+    FrameStatus status = FrameStatus::Ok;
+    bool keyInstalled = false;  // this packet switched on the session key
+};
+
+// Stage 1 result: the layers that apply to one frame. Holds its own
+// reference to the key, so stage 2 can run on any thread, any time later.
+struct DecodePlan {
+    Keystream ks;
+    KeyPtr key;
+};
+
+// Decode state of one ENet connection: which XOR layers apply and the
+// session key learnt from GetPlayerTokenRsp. Used by the live hooks and by
+// offline replay so both run exactly the same pipeline.
+class PacketDecoder {
+public:
+    // Decodes one raw ENet payload. `sessionIndex` is the 1-based position
+    // of the packet within its connection (it selects the ec2b layer).
+    // `rec` supplies index, direction and timestamp and receives cmd id and
+    // lengths; on success `out` holds the encoded record (RecordHeader +
+    // PacketHead + payload).
+    DecodeResult Decode(const uint8_t* raw, size_t len, uint64_t sessionIndex, RecordHeader& rec, PacketBuffer& out);
+
+    // Decode split for a pipeline. DecodeHeader and Commit see and change
+    // key state and must run in packet order; DecodeBody only reads the
+    // plan. A packet for which IsBarrier() holds must be committed before
+    // the next DecodeHeader.
+    FrameStatus DecodeHeader(const uint8_t* raw, size_t len, uint64_t sessionIndex, RecordHeader& rec, DecodePlan& plan) const;
+    // Decrypts PacketHead and payload (rec.BodySize() bytes) into `dst`,
+    // which may alias the frame bytes at kFrameHeaderSize.
+    static void DecodeBody(uint8_t* dst, const uint8_t* raw, const RecordHeader& rec, const DecodePlan& plan);
+    DecodeResult Commit(const RecordHeader& rec, const uint8_t* payload);
+    static bool IsBarrier(uint16_t cmdId) { return cmdId == GET_PLAYER_TOKEN_RSP; }
+
+    // True if `raw` is a GetPlayerTokenReq under the ec2b layer alone, i.e.
+    // the first packet of a new connection.
+    static bool IsSessionStart(const uint8_t* raw, size_t len);
+    // True if `raw` is a barrier packet of the token exchange, checked the
+    // same way (no decoder state needed).
+    static bool IsBarrierFrame(const uint8_t* raw, size_t len);
+
+    void Reset();
+
+private:
+    void PlanFor(uint64_t index, DecodePlan& plan) const;
+
+    // Only touched in packet order (DecodeHeader/Commit); plans carry
+    // their own key reference onwards.
+    KeyPtr key_;
+    bool doXor_ = false;
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// The fields of the PacketHead message that precedes every payload. Absent
+// fields are 0.
+struct PacketHead {
+    uint32_t packetId = 0;          // 1
+    uint32_t rpcId = 0;             // 2
+    uint32_t clientSequenceId = 0;  // 3, echoed by the server in responses
+    uint32_t enetChannelId = 0;     // 4
+    uint32_t enetIsReliable = 0;    // 5
+    uint64_t sentMs = 0;            // 6
+    uint32_t userId = 0;            // 11
+    uint32_t userSessionId = 0;     // 13
+    uint64_t recvTimeMs = 0;        // 21
+};
+
+// False if `head` is not valid wire format; fields decoded up to that
+// point are kept.
+bool DecodePacketHead(const uint8_t* head, size_t len, PacketHead& out);
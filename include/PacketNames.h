@@ -0,0 +1,34 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Dense cmd id -> name table generated at compile time from the list in
+// PacketNames.cpp. Every known id is below this bound (static_assert'ed).
+static constexpr size_t kPacketNameTableSize = 1 << 14;
+
+extern const std::array<std::string_view, kPacketNameTableSize> g_packetNameTable;
+
+// <X>Req <-> <X>Rsp pairs from the same list, 0 where there is none.
+extern const std::array<uint16_t, kPacketNameTableSize> g_packetRspTable;
+extern const std::array<uint16_t, kPacketNameTableSize> g_packetReqTable;
+
+// Name of `cmd`, or an empty view if the id is unknown. No allocation.
+inline std::string_view PacketIdToName(uint16_t cmd) {
+    return cmd < kPacketNameTableSize ? g_packetNameTable[cmd] : std::string_view();
+}
+
+// Response id answering request `req`, or 0.
+inline uint16_t PacketRspFor(uint16_t req) {
+    return req < kPacketNameTableSize ? g_packetRspTable[req] : 0;
+}
+
+// Request id answered by response `rsp`, or 0.
+inline uint16_t PacketReqFor(uint16_t rsp) {
+    return rsp < kPacketNameTableSize ? g_packetReqTable[rsp] : 0;
+}
+
+// Id of the cmd called `name`, or 0 if there is none. Linear scan, meant
+// for config parsing.
+uint16_t PacketNameToId(std::string_view name);
@@ -1,12 +1,51 @@
 #pragma once
-#include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
 
-enum class PacketSource {
-    Client,
-    Server
+enum class PacketSource : uint8_t {
+    Client = 0,
+    Server = 1
 };
 
+enum class Codec : uint8_t;
+
 namespace PacketProcessor {
-    void Process(const std::vector<uint8_t>& bytes, PacketSource src);
+    // Queues one raw ENet payload sent or received on `peer` for decoding:
+    // one copy into a pooled buffer and a push, the rest runs on the decode
+    // pipeline (see PacketProcessor.cpp) and reaches the writer in call
+    // order. Each peer is its own session (packet numbering and key), so
+    // several connections can be decoded at once.
+    void Process(const void* peer, const uint8_t* data, size_t len, PacketSource src);
+
+    // Single-connection form (replay drivers, benchmarks).
+    void Process(const uint8_t* data, size_t len, PacketSource src);
+
+    // Forgets the session of `peer` once its queued packets are decoded;
+    // its next packet starts a new one.
+    void ResetPeer(const void* peer);
+
+    // Re-reads the cmd_filter rules and swaps them in without stopping
+    // capture. False if no filter is configured or the file can't be read.
+    bool ReloadFilter();
+
+    // Per-session packet counts.
+    void ReportSessions(FILE* out);
+
+    // In-flight bytes against memory_budget and what the overflow policy
+    // dropped or blocked.
+    void ReportMemory(FILE* out);
+
+    // Request/response round trips seen so far (see Correlator).
+    void ReportRtt(FILE* out);
+
+    // Frames rejected so far (bad magic, lengths or trailer).
+    uint64_t FrameErrors();
+
+    void _InternalShutdown();
+    // Self-checks: switch the capture codec, only while drained. False if
+    // captures aren't written as segments or the codec isn't built in.
+    bool _InternalSetCompression(Codec codec);
+    // Self-checks: waits until everything queued so far is written.
+    void _InternalDrain();
 }
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// Thin OS layer used by the portable decode core. Implemented once per
+// platform in Platform_Win32.cpp / Platform_Posix.cpp.
+namespace Platform {
+    // Native file handle (HANDLE on Windows, fd on POSIX).
+    using FileHandle = intptr_t;
+    static constexpr FileHandle kInvalidFile = -1;
+
+    // Directory of the host executable (the game when injected).
+    std::filesystem::path GetBaseDir();
+
+    // Current process id, used to keep concurrent sessions apart.
+    uint32_t GetProcessId();
+
+    // Create or truncate `path` for sequential writing.
+    FileHandle CreateWriteFile(const std::filesystem::path& path);
+    bool WriteAll(FileHandle h, const void* data, size_t len);
+
+    // One piece of a gathered write.
+    struct IoSlice {
+        const void* data;
+        size_t len;
+    };
+    // Write all slices back to back with as few syscalls as possible
+    // (writev on POSIX; coalesced into one WriteFile on Windows, where
+    // WriteFileGather needs unbuffered page-sized I/O).
+    bool WriteGather(FileHandle h, const IoSlice* slices, size_t count);
+    void CloseFile(FileHandle h);
+
+    // Read-only view of a whole file.
+    struct MappedFile {
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        intptr_t mapping = 0;  // section handle on Windows, unused on POSIX
+    };
+    bool MapFileReadOnly(const std::filesystem::path& path, MappedFile& out);
+    void UnmapFile(MappedFile& m);
+
+    // Create or truncate `path` and write `len` bytes to it.
+    bool WriteWholeFile(const std::filesystem::path& path, const uint8_t* data, size_t len);
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "ProtoWire.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// Zero-copy protobuf wire-format scanner. One pass over a payload yields a
+// flat index of every field; values are read straight from the payload
+// through the index, so later queries never re-parse the bytes.
+
+enum ProtoWireType : uint8_t {
+    kWireVarint = 0,
+    kWireFixed64 = 1,
+    kWireLen = 2,
+    kWireFixed32 = 5,
+};
+
+enum ProtoFieldFlags : uint8_t {
+    // A length-delimited field whose bytes parsed cleanly as a message; its
+    // fields follow it in the index with `parent` pointing back here.
+    kFieldMessage = 1 << 0,
+};
+
+static constexpr uint32_t kNoParent = 0xFFFFFFFFu;
+
+// Offsets are relative to the scanned payload. For varints `offset` and
+// `length` cover the encoded bytes, for length-delimited fields the content
+// after the length prefix.
+struct ProtoField {
+    uint32_t field;
+    uint32_t offset;
+    uint32_t length;
+    uint32_t parent;    // index of the enclosing message field, or kNoParent
+    uint8_t wireType;   // ProtoWireType
+    uint8_t depth;      // 0 = top level
+    uint8_t flags;      // ProtoFieldFlags
+    uint8_t reserved;
+};
+static_assert(sizeof(ProtoField) == 20, "ProtoField is stored as-is in capture segments");
+
+struct ProtoScanLimits {
+    uint32_t maxDepth = 8;          // nested messages deeper than this stay opaque bytes
+    uint32_t maxFields = 1u << 16;  // stop once the index holds this many fields
+    uint32_t maxBytes = 64u << 20;  // refuse larger payloads
+};
+
+enum class ProtoScanStatus : uint8_t {
+    Ok,
+    Malformed,      // top level is not valid wire format; index holds the valid prefix
+    TooManyFields,  // maxFields reached; index is truncated
+    TooLarge,       // payload exceeds maxBytes; index is empty
+};
+
+// Replaces `out` with the index of `data`. Nested messages are detected by
+// trial parsing, like protoc --decode_raw.
+ProtoScanStatus ScanProto(const uint8_t* data, size_t len, std::vector<ProtoField>& out,
+    const ProtoScanLimits& limits = ProtoScanLimits());
+
+// First field numbered `field` directly under `parent`.
+const ProtoField* FindProtoField(const ProtoField* fields, size_t count, uint32_t field,
+    uint32_t parent = kNoParent);
+
+bool ProtoVarint(const uint8_t* base, const ProtoField& f, uint64_t& out);
+
+static inline std::string_view ProtoBytes(const uint8_t* base, const ProtoField& f) {
+    return std::string_view(reinterpret_cast<const char*>(base + f.offset), f.length);
+}
+
+static inline uint64_t ProtoFixed64(const uint8_t* base, const ProtoField& f) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | base[f.offset + i];
+    return v;
+}
+
+static inline uint32_t ProtoFixed32(const uint8_t* base, const ProtoField& f) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; --i) v = (v << 8) | base[f.offset + i];
+    return v;
+}
+
+// Packed repeated varints (a length-delimited field), appended to `out`.
+static inline bool ProtoPackedVarints(const uint8_t* base, const ProtoField& f, std::vector<uint64_t>& out) {
+    return f.wireType == kWireLen && ReadPackedVarints(base + f.offset, f.length, out);
+}
+
+// Stored form: the ProtoField layout above, little-endian, packed.
+static constexpr size_t kProtoFieldSize = sizeof(ProtoField);
+
+void EncodeProtoIndex(const ProtoField* fields, size_t count, uint8_t* out);
+ProtoField DecodeProtoField(const uint8_t* index, size_t i);
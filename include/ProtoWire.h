@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline bool ReadVarint(const uint8_t*& p, const uint8_t* end, uint64_t& out) {
+    uint64_t v = 0; int shift = 0;
+    while (p < end && shift <= 63) {
+        uint8_t b = *p++;
+        v |= uint64_t(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) { out = v; return true; }
+        shift += 7;
+    }
+    return false;
+}
+static inline bool ReadLen(const uint8_t*& p, const uint8_t* end, size_t& len) {
+    uint64_t v = 0;
+    if (!ReadVarint(p, end, v)) return false;
+    if (v > size_t(end - p)) return false;
+    len = size_t(v);
+    return true;
+}
+
+// Bulk decode: up to `max` consecutive varints from [p, end) into `out`.
+// Returns how many were decoded and advances `p` past them. Stops early at a
+// truncated or malformed varint, leaving `p` at its first byte. Same results
+// as calling ReadVarint in a loop.
+size_t ReadVarints(const uint8_t*& p, const uint8_t* end, uint64_t* out, size_t max);
+
+// Body of a packed repeated varint field, appended to `out`. False if it
+// does not end on a varint boundary.
+bool ReadPackedVarints(const uint8_t* data, size_t len, std::vector<uint64_t>& out);
+
+using VarintKernelFn = size_t (*)(const uint8_t*& p, const uint8_t* end, uint64_t* out, size_t max);
+
+// The SIMD kernels take the continuation bits of 64 bytes at once
+// (movemask). Windows holding only 1-2 byte varints are decoded eight bytes
+// per step with a shuffle; other windows walk the terminator bits and
+// decode each varint without a per-byte branch. The tail goes through
+// ReadVarint.
+size_t ReadVarints_Scalar(const uint8_t*& p, const uint8_t* end, uint64_t* out, size_t max);
+#if defined(SNIFFER_X86_KERNELS)
+size_t ReadVarints_SSSE3(const uint8_t*& p, const uint8_t* end, uint64_t* out, size_t max);
+size_t ReadVarints_AVX2(const uint8_t*& p, const uint8_t* end, uint64_t* out, size_t max);
+#endif
+
+// Name of the kernel in use ("scalar", "ssse3", "avx2").
+const char* VarintKernelName();
+
+// Pin a specific kernel (for benchmarks). Returns false if it is unknown or
+// not supported on this CPU.
+bool ForceVarintKernel(const char* name);
+
+// ---- kernel helpers ----------------------------------------------------------------
+
+static inline unsigned VarintCtz64(uint64_t x) {
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return unsigned(i);
+#else
+    return unsigned(__builtin_ctzll(x));
+#endif
+}
+
+// Value of the varint of `len` (1..10) bytes at `v`. Reads 16 bytes.
+static inline uint64_t VarintFromBytes(const uint8_t* v, unsigned len) {
+    static constexpr uint64_t kLo[11] = { 0, 0xFF, 0xFFFF, 0xFFFFFF, 0xFFFFFFFF, 0xFFFFFFFFFFull,
+        0xFFFFFFFFFFFFull, 0xFFFFFFFFFFFFFFull, ~0ull, ~0ull, ~0ull };
+    static constexpr uint64_t kHi[11] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x7F, 0x17F };
+    uint64_t lo, hi;
+    std::memcpy(&lo, v, 8);
+    std::memcpy(&hi, v + 8, 8);
+    uint64_t x = lo & kLo[len] & 0x7F7F7F7F7F7F7F7Full;
+    x = (x & 0x007F007F007F007Full) | ((x & 0x7F007F007F007F00ull) >> 1);
+    x = (x & 0x00003FFF00003FFFull) | ((x & 0x3FFF00003FFF0000ull) >> 2);
+    x = (x & 0x000000000FFFFFFFull) | ((x & 0x0FFFFFFF00000000ull) >> 4);
+    hi &= kHi[len];
+    return x | (hi << 56) | ((hi >> 8) << 63);
+}
+
+// Shuffles that gather the 16-bit values starting at the set bits of an
+// 8-byte window to the front. Indexed by the start bits 1..7 (byte 0
+// always starts a varint).
+struct VarintShuffle {
+    alignas(16) uint8_t lanes[128][16];
+    uint8_t count[128];
+};
+extern const VarintShuffle kVarintShuffle;
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Puts results of a parallel stage back in ticket order. Tickets are handed
+// out densely from 0 by one dispatcher; any thread may complete a ticket and
+// a single consumer takes them in order. The dispatcher must not run more
+// than Capacity() tickets ahead of the consumer (HasRoom). Capacity is
+// rounded up to a power of two.
+template <typename T>
+class ReorderRing {
+public:
+    explicit ReorderRing(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        slots_.reset(new Slot[cap]);
+    }
+
+    ReorderRing(const ReorderRing&) = delete;
+    ReorderRing& operator=(const ReorderRing&) = delete;
+
+    // Dispatcher.
+    bool HasRoom(uint64_t ticket) const {
+        return ticket - head_.load(std::memory_order_acquire) <= mask_;
+    }
+
+    // Any thread, once per ticket.
+    void Complete(uint64_t ticket, T& v) {
+        Slot& slot = slots_[ticket & mask_];
+        slot.value = std::move(v);
+        slot.ready.store(ticket + 1, std::memory_order_release);
+    }
+
+    // Consumer only. False if the next ticket in order is not done yet.
+    bool TryPop(T& out) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[head & mask_];
+        if (slot.ready.load(std::memory_order_acquire) != head + 1) return false;
+        out = std::move(slot.value);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only.
+    bool Ready() const {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        return slots_[head & mask_].ready.load(std::memory_order_acquire) == head + 1;
+    }
+
+    size_t Capacity() const { return mask_ + 1; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> ready{ 0 };  // ticket + 1 once completed
+        T value{};
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<uint64_t> head_{ 0 };
+};
@@ -0,0 +1,117 @@
+#pragma once
+#include "CmdFilter.h"
+#include "PacketDecoder.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct SessionCounters {
+    std::atomic<uint64_t> packets[2] = {};  // by PacketSource
+    std::atomic<uint64_t> bytes[2] = {};
+    std::atomic<uint64_t> frameErrors{ 0 };
+    std::atomic<uint64_t> filtered[2] = {};  // dropped by cmd_filter
+    std::atomic<uint64_t> sampledOut[2] = {};  // passed the filter, not sampled
+};
+
+// Decode state of one ENet connection: its own packet numbering (the ec2b
+// pad covers its first two packets), its own PacketDecoder and therefore
+// its own session key, and counters.
+class Session {
+public:
+    Session(uint64_t id, const void* peer) : id_(id), peer_(peer) {}
+
+    // Process-unique, 1-based; stored with raw records for replay.
+    uint64_t Id() const { return id_; }
+    const void* Peer() const { return peer_; }
+
+    // 1-based position of the next packet within this session.
+    uint64_t NextIndex() { return packets_.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+    PacketDecoder& Decoder() { return decoder_; }
+    SessionCounters& Counters() { return counters_; }
+    const SessionCounters& Counters() const { return counters_; }
+    // cmd_filter first-N counts; sequencer only.
+    SessionSamples& Samples() { return samples_; }
+
+private:
+    const uint64_t id_;
+    const void* const peer_;
+    std::atomic<uint64_t> packets_{ 0 };
+    PacketDecoder decoder_;
+    SessionCounters counters_;
+    SessionSamples samples_;
+};
+
+// Sessions by ENet peer pointer. Lookups are lock-free: peers sit in a
+// fixed open-addressing table and each slot publishes its current Session
+// through an atomic pointer. Removed peers leave a tombstone that a later
+// peer can claim, so the table holds kMaxPeers live peers, not kMaxPeers
+// over the process lifetime. Replaced sessions are retired and freed once
+// no reader that could have seen them is left (two-epoch grace period), so
+// a thread holding a ReadSection (the decoder, a report) never sees a freed
+// Session.
+class SessionTable {
+public:
+    static constexpr size_t kMaxPeers = 1024;
+
+    // Pins the sessions visible while it is alive. Hold one for as long as
+    // a Session* from this table is used.
+    class ReadSection {
+    public:
+        explicit ReadSection(SessionTable& t);
+        ~ReadSection();
+        ReadSection(const ReadSection&) = delete;
+        ReadSection& operator=(const ReadSection&) = delete;
+    private:
+        SessionTable& table_;
+        unsigned parity_;
+    };
+
+    SessionTable();
+    ~SessionTable();
+
+    // Current session of `peer`, created on first use. Null only if
+    // kMaxPeers peers are connected.
+    Session* Get(const void* peer);
+
+    // Starts a fresh session for `peer` (reconnect on a reused peer) and
+    // retires the old one.
+    Session* Restart(const void* peer);
+
+    // Drops the session of `peer` (disconnect or peer reset). Returns the
+    // id of the session it ended, 0 if there was none.
+    uint64_t Remove(const void* peer);
+
+    // One line per live session.
+    void Report(FILE* out);
+
+private:
+    struct Slot {
+        std::atomic<const void*> peer{ nullptr };
+        std::atomic<Session*> session{ nullptr };
+    };
+    struct Retired {
+        Session* session;
+        uint64_t epoch;
+    };
+
+    Slot* FindSlot(const void* peer, bool create);
+    static bool ClaimSlot(Slot& slot, const void* expected, const void* peer);
+    Session* Replace(Slot& slot, const void* peer, bool fresh);
+    void Retire(Session* s);
+    void TryAdvance();
+
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> nextId_{ 1 };
+
+    std::atomic<uint64_t> epoch_{ 0 };
+    std::atomic<uint64_t> readers_[2] = {};
+
+    std::mutex retireLock_;
+    std::vector<Retired> retired_;
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+static constexpr size_t kSessionKeySize = 4096;
+
+// Writes the kSessionKeySize-byte key for `seed` (512 big-endian MT64
+// outputs) straight into `out`.
+void DeriveKeyInto(uint64_t seed, uint8_t* out);
+
+std::vector<uint8_t> NewKeyFromSeed(uint64_t seed);
+
+bool ExtractSecretKeySeed(const uint8_t* payload, size_t payloadLen, uint64_t& secretKeySeed);
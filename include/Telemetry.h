@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Always-on latency instrumentation for the hook and decode path. Each
+// thread records into its own log-linear (HDR-style) histograms with plain
+// stores; readers merge all threads on demand.
+namespace Telemetry {
+    enum class Stage : uint8_t {
+        Detour,     // our work inside a hook, excluding the original ENet call
+        Framing,    // stage 1: header/trailer decrypt and validation
+        Xor,        // stage 2: PacketHead + payload decrypt
+        QueuePush,  // handing the frame to the decode pipeline
+        QueueWait,  // time a frame sits in the hook queue
+        Compress,   // stage 2: payload compression of a decoded record
+        Reorder,    // time a decoded record waits for earlier ones and the writer
+        DiskWrite,  // one writer flush (batch or legacy file)
+        Count
+    };
+
+    const char* StageName(Stage s);
+
+    // Raw timestamp: TSC on x86, steady_clock nanoseconds elsewhere.
+    uint64_t Now();
+
+    void Record(Stage s, uint64_t ticks);
+
+    struct Summary {
+        uint64_t count = 0;
+        double p50Ns = 0, p99Ns = 0, p999Ns = 0, maxNs = 0;
+    };
+    Summary Snapshot(Stage s);
+
+    // Prints count and p50/p99/p999/max per stage.
+    void Report(FILE* out);
+
+    // Single-owner histogram with the same buckets, for values that are not
+    // stage timings (e.g. round trips in ns). Buckets are allocated on the
+    // first Record.
+    class Histogram {
+    public:
+        void Record(uint64_t v);
+        uint64_t Count() const { return count_; }
+        uint64_t Max() const { return max_; }
+        // Lower bound of the bucket holding quantile `q` (0..1).
+        uint64_t Percentile(double q) const;
+    private:
+        std::vector<uint64_t> counts_;
+        uint64_t count_ = 0;
+        uint64_t max_ = 0;
+    };
+
+    class Scope {
+    public:
+        explicit Scope(Stage s) : stage_(s), start_(Now()) {}
+        ~Scope() { Record(stage_, Now() - start_); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        Stage stage_;
+        uint64_t start_;
+    };
+}
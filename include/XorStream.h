@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// dst[i] = src[i] ^ pad[i] for n bytes. dst may equal src.
+using XorKernelFn = void (*)(uint8_t* dst, const uint8_t* src, const uint8_t* pad, size_t n);
+
+// Vectorized kernels, selected once at startup from CpuFeatures.
+void XorKernel_Scalar(uint8_t* dst, const uint8_t* src, const uint8_t* pad, size_t n);
+#if defined(SNIFFER_X86_KERNELS)
+void XorKernel_SSE2(uint8_t* dst, const uint8_t* src, const uint8_t* pad, size_t n);
+void XorKernel_AVX2(uint8_t* dst, const uint8_t* src, const uint8_t* pad, size_t n);
+void XorKernel_AVX512(uint8_t* dst, const uint8_t* src, const uint8_t* pad, size_t n);
+#endif
+
+// XOR `len` bytes at `data` with a repeating keystream `pad` of `padLen`
+// bytes, starting at keystream position `padOffset`. The pad is walked in
+// contiguous runs, so there is no per-byte modulo.
+void XorKeystream(uint8_t* data, size_t len,
+    const uint8_t* pad, size_t padLen, size_t padOffset = 0);
+
+// Same as XorKeystream but reads `src` and writes the result to `dst`,
+// fusing the copy into the decrypt pass.
+void XorKeystreamCopy(uint8_t* dst, const uint8_t* src, size_t len,
+    const uint8_t* pad, size_t padLen, size_t padOffset = 0);
+
+// Name of the kernel in use ("scalar", "sse2", "avx2", "avx512").
+const char* XorKernelName();
+
+// Pin a specific kernel (for benchmarks). Returns false if it is unknown or
+// not supported on this CPU.
+bool ForceXorKernel(const char* name);
@@ -3,9 +3,19 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <vector>
+
+// Raw ec2b blobs are this size and start with "Ec2b".
+static constexpr std::size_t kEc2bBlobSize = 2076;
+
+// Throws std::invalid_argument unless size == kEc2bBlobSize.
+std::array<uint8_t,4096> derive_xorpad_from_ec2b(const uint8_t* ec2b, std::size_t size);
 
 std::array<uint8_t,4096> derive_xorpad_from_b64(const char* b64, std::size_t len);
 
+// Base64 to bytes, whitespace ignored. Throws std::runtime_error on bad input.
+std::vector<uint8_t> ec2b_decode_b64(const char* b64, std::size_t len);
+
 inline std::array<uint8_t,4096> derive_xorpad_from_b64(const std::string& s) {
     return derive_xorpad_from_b64(s.c_str(), s.size());
 }
@@ -1,5 +1,12 @@
 #pragma once
-#include <vector>
+#include <array>
+#include <cstddef>
 #include <cstdint>
 
-extern const std::vector<uint8_t> g_ec2b_xorpad;
+static constexpr std::size_t kEc2bXorpadSize = 4096;
+using Ec2bXorpad = std::array<uint8_t, kEc2bXorpadSize>;
+
+// Xorpad of the built-in ec2b blob (ec2b_data.cpp). Normally a constant
+// table generated at build time by ec2b_gen; derived on first use when the
+// generator could not run (cross compiles).
+const Ec2bXorpad& ec2b_xorpad();
@@ -0,0 +1,209 @@
+#include "AesMhy.h"
+#include "CpuFeatures.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+
+// ---- tables, generated at compile time ----------------------------------------
+
+static constexpr uint8_t GfMul(uint8_t a, uint8_t b) {
+    uint8_t r = 0;
+    while (b) {
+        if (b & 1) r ^= a;
+        a = uint8_t((a << 1) ^ ((a & 0x80) ? 0x1B : 0));
+        b >>= 1;
+    }
+    return r;
+}
+
+static constexpr uint8_t Rotl8(uint8_t x, int n) { return uint8_t((x << n) | (x >> (8 - n))); }
+
+static constexpr std::array<uint8_t, 256> BuildSbox() {
+    std::array<uint8_t, 256> s{};
+    for (int x = 0; x < 256; ++x) {
+        // x^254 is the multiplicative inverse (0 maps to 0).
+        uint8_t inv = 1, base = uint8_t(x);
+        for (int e = 254; e; e >>= 1) {
+            if (e & 1) inv = GfMul(inv, base);
+            base = GfMul(base, base);
+        }
+        if (x == 0) inv = 0;
+        s[x] = uint8_t(inv ^ Rotl8(inv, 1) ^ Rotl8(inv, 2) ^ Rotl8(inv, 3) ^ Rotl8(inv, 4) ^ 0x63);
+    }
+    return s;
+}
+
+static constexpr std::array<uint8_t, 256> Invert(const std::array<uint8_t, 256>& s) {
+    std::array<uint8_t, 256> inv{};
+    for (int x = 0; x < 256; ++x) inv[s[x]] = uint8_t(x);
+    return inv;
+}
+
+static constexpr std::array<uint8_t, 256> kSbox = BuildSbox();
+static constexpr std::array<uint8_t, 256> kInvSbox = Invert(kSbox);
+
+// Column contribution of row-0 byte x, little-endian (byte r = output row r).
+// Forward: MixColumns(SubBytes) = (2,1,1,3)·S[x].
+// Inverse: InvMixColumns(InvSubBytes) = (14,9,13,11)·S⁻¹[x].
+static constexpr std::array<uint32_t, 256> BuildT(const std::array<uint8_t, 256>& s,
+    uint8_t m0, uint8_t m1, uint8_t m2, uint8_t m3) {
+    std::array<uint32_t, 256> t{};
+    for (int x = 0; x < 256; ++x) {
+        t[x] = uint32_t(GfMul(s[x], m0)) | uint32_t(GfMul(s[x], m1)) << 8
+            | uint32_t(GfMul(s[x], m2)) << 16 | uint32_t(GfMul(s[x], m3)) << 24;
+    }
+    return t;
+}
+
+static constexpr std::array<uint32_t, 256> kTe = BuildT(kSbox, 2, 1, 1, 3);
+static constexpr std::array<uint32_t, 256> kTd = BuildT(kInvSbox, 14, 9, 13, 11);
+
+static_assert(kSbox[0x00] == 0x63 && kSbox[0x53] == 0xED, "AES S-box");
+static_assert(kInvSbox[0x63] == 0x00, "AES inverse S-box");
+
+// ---- T-table backend -----------------------------------------------------------
+
+static inline uint32_t Rotl32(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+static inline uint32_t LoadCol(const uint8_t* p) {
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+static inline void StoreCol(uint8_t* p, uint32_t v) {
+    p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); p[2] = uint8_t(v >> 16); p[3] = uint8_t(v >> 24);
+}
+static inline uint8_t Row(uint32_t col, int r) { return uint8_t(col >> (8 * r)); }
+
+// One full round. `dir` is +1 for ShiftRows (row r reads column c + r) and
+// -1 for InvShiftRows (column c - r).
+template <int Dir>
+static inline void Round(const uint32_t (&s)[4], uint32_t (&o)[4], const std::array<uint32_t, 256>& t, const uint32_t* rk) {
+    for (int c = 0; c < 4; ++c) {
+        o[c] = t[Row(s[c], 0)]
+            ^ Rotl32(t[Row(s[(c + Dir * 1 + 4) & 3], 1)], 8)
+            ^ Rotl32(t[Row(s[(c + Dir * 2 + 4) & 3], 2)], 16)
+            ^ Rotl32(t[Row(s[(c + Dir * 3 + 4) & 3], 3)], 24)
+            ^ rk[c];
+    }
+}
+
+template <int Dir>
+static inline void LastRound(const uint32_t (&s)[4], uint8_t* out, const std::array<uint8_t, 256>& sbox, const uint32_t* rk) {
+    for (int c = 0; c < 4; ++c) {
+        const uint32_t v = uint32_t(sbox[Row(s[c], 0)])
+            | uint32_t(sbox[Row(s[(c + Dir * 1 + 4) & 3], 1)]) << 8
+            | uint32_t(sbox[Row(s[(c + Dir * 2 + 4) & 3], 2)]) << 16
+            | uint32_t(sbox[Row(s[(c + Dir * 3 + 4) & 3], 3)]) << 24;
+        StoreCol(out + 4 * c, v ^ rk[c]);
+    }
+}
+
+template <int Dir>
+static void CryptTTable(const uint8_t (&rk)[11][16], const uint8_t* in, uint8_t* out, size_t blocks,
+    const std::array<uint32_t, 256>& t, const std::array<uint8_t, 256>& sbox) {
+    uint32_t k[11][4];
+    for (int r = 0; r < 11; ++r)
+        for (int c = 0; c < 4; ++c) k[r][c] = LoadCol(rk[r] + 4 * c);
+
+    for (size_t b = 0; b < blocks; ++b, in += 16, out += 16) {
+        uint32_t s[4], o[4];
+        for (int c = 0; c < 4; ++c) s[c] = LoadCol(in + 4 * c) ^ k[0][c];
+        for (int r = 1; r < 10; r += 2) {
+            Round<Dir>(s, o, t, k[r]);
+            if (r + 1 == 10) { std::memcpy(s, o, sizeof(s)); break; }
+            Round<Dir>(o, s, t, k[r + 1]);
+        }
+        LastRound<Dir>(s, out, sbox, k[10]);
+    }
+}
+
+void MhyAesEncrypt_TTable(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks) {
+    CryptTTable<-1>(key.enc, in, out, blocks, kTd, kInvSbox);
+}
+
+void MhyAesDecrypt_TTable(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks) {
+    CryptTTable<+1>(key.dec, in, out, blocks, kTe, kSbox);
+}
+
+// ---- key preparation ---------------------------------------------------------------
+
+static void MixColumns(const uint8_t* in, uint8_t* out) {
+    for (int c = 0; c < 4; ++c) {
+        const uint8_t a0 = in[4 * c], a1 = in[4 * c + 1], a2 = in[4 * c + 2], a3 = in[4 * c + 3];
+        out[4 * c + 0] = uint8_t(GfMul(a0, 2) ^ GfMul(a1, 3) ^ a2 ^ a3);
+        out[4 * c + 1] = uint8_t(a0 ^ GfMul(a1, 2) ^ GfMul(a2, 3) ^ a3);
+        out[4 * c + 2] = uint8_t(a0 ^ a1 ^ GfMul(a2, 2) ^ GfMul(a3, 3));
+        out[4 * c + 3] = uint8_t(GfMul(a0, 3) ^ a1 ^ a2 ^ GfMul(a3, 2));
+    }
+}
+
+void MhyAesPrepare(const uint8_t roundKeys[176], MhyAesKey& key) {
+    std::memcpy(key.enc, roundKeys, 176);
+    // Reference decrypt: x ^= rk10; then 9x { SB(SR(x)); x ^= rk[9-i]; MC }
+    // and SB(SR(x)) ^ rk0. Moving MC across the key xor gives
+    // AESENC(x, MC(rk[9-i])) per round.
+    std::memcpy(key.dec[0], roundKeys + 160, 16);
+    for (int r = 1; r < 10; ++r) MixColumns(roundKeys + 16 * (10 - r), key.dec[r]);
+    std::memcpy(key.dec[10], roundKeys, 16);
+}
+
+// ---- dispatch ------------------------------------------------------------------------
+
+namespace {
+    struct BackendEntry {
+        const char* name;
+        MhyAesFn encrypt;
+        MhyAesFn decrypt;
+        bool (*supported)(const CpuFeatures&);
+    };
+
+    // Ordered from most to least preferred.
+    const BackendEntry kBackends[] = {
+#if defined(SNIFFER_X86_KERNELS)
+        { "aesni",  MhyAesEncrypt_AESNI,  MhyAesDecrypt_AESNI,  [](const CpuFeatures& f) { return f.aesni; } },
+#endif
+        { "ttable", MhyAesEncrypt_TTable, MhyAesDecrypt_TTable, [](const CpuFeatures&) { return true; } },
+    };
+
+    const BackendEntry* PickBackend() {
+        const CpuFeatures& f = GetCpuFeatures();
+        for (const auto& b : kBackends)
+            if (b.supported(f)) return &b;
+        return &kBackends[sizeof(kBackends) / sizeof(kBackends[0]) - 1];
+    }
+
+    std::atomic<const BackendEntry*> g_backend{ nullptr };
+
+    inline const BackendEntry* Backend() {
+        const BackendEntry* b = g_backend.load(std::memory_order_relaxed);
+        if (!b) {
+            b = PickBackend();
+            g_backend.store(b, std::memory_order_relaxed);
+        }
+        return b;
+    }
+}
+
+void MhyAesEncrypt(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks) {
+    Backend()->encrypt(key, in, out, blocks);
+}
+
+void MhyAesDecrypt(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks) {
+    Backend()->decrypt(key, in, out, blocks);
+}
+
+const char* MhyAesBackendName() {
+    return Backend()->name;
+}
+
+bool ForceMhyAesBackend(const char* name) {
+    const CpuFeatures& f = GetCpuFeatures();
+    for (const auto& b : kBackends) {
+        if (std::strcmp(b.name, name) == 0) {
+            if (!b.supported(f)) return false;
+            g_backend.store(&b, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
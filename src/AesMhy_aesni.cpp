@@ -0,0 +1,50 @@
+#include "AesMhy.h"
+#include <immintrin.h>
+
+// Four blocks in flight hide the AESENC/AESDEC latency.
+
+template <bool Enc>
+static inline __m128i Round(__m128i x, __m128i k) {
+    return Enc ? _mm_aesdec_si128(x, k) : _mm_aesenc_si128(x, k);
+}
+template <bool Enc>
+static inline __m128i LastRound(__m128i x, __m128i k) {
+    return Enc ? _mm_aesdeclast_si128(x, k) : _mm_aesenclast_si128(x, k);
+}
+
+template <bool Enc>
+static void Crypt(const uint8_t (&rk)[11][16], const uint8_t* in, uint8_t* out, size_t blocks) {
+    __m128i k[11];
+    for (int r = 0; r < 11; ++r) k[r] = _mm_load_si128((const __m128i*)rk[r]);
+
+    size_t b = 0;
+    for (; b + 4 <= blocks; b += 4) {
+        __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + 16 * b)), k[0]);
+        __m128i x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + 16 * b + 16)), k[0]);
+        __m128i x2 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + 16 * b + 32)), k[0]);
+        __m128i x3 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + 16 * b + 48)), k[0]);
+        for (int r = 1; r < 10; ++r) {
+            x0 = Round<Enc>(x0, k[r]);
+            x1 = Round<Enc>(x1, k[r]);
+            x2 = Round<Enc>(x2, k[r]);
+            x3 = Round<Enc>(x3, k[r]);
+        }
+        _mm_storeu_si128((__m128i*)(out + 16 * b), LastRound<Enc>(x0, k[10]));
+        _mm_storeu_si128((__m128i*)(out + 16 * b + 16), LastRound<Enc>(x1, k[10]));
+        _mm_storeu_si128((__m128i*)(out + 16 * b + 32), LastRound<Enc>(x2, k[10]));
+        _mm_storeu_si128((__m128i*)(out + 16 * b + 48), LastRound<Enc>(x3, k[10]));
+    }
+    for (; b < blocks; ++b) {
+        __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + 16 * b)), k[0]);
+        for (int r = 1; r < 10; ++r) x = Round<Enc>(x, k[r]);
+        _mm_storeu_si128((__m128i*)(out + 16 * b), LastRound<Enc>(x, k[10]));
+    }
+}
+
+void MhyAesEncrypt_AESNI(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks) {
+    Crypt<true>(key.enc, in, out, blocks);
+}
+
+void MhyAesDecrypt_AESNI(const MhyAesKey& key, const uint8_t* in, uint8_t* out, size_t blocks) {
+    Crypt<false>(key.dec, in, out, blocks);
+}
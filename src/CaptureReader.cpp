@@ -0,0 +1,148 @@
+#include "CaptureReader.h"
+#include "Compression.h"
+#include "ProtoScan.h"
+
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+bool CaptureReader::Open(const fs::path& path) {
+    Close();
+    if (!Platform::MapFileReadOnly(path, map_)) return false;
+    if (!DecodeSegmentHeader(map_.data, map_.size, seg_)) {
+        Close();
+        return false;
+    }
+    pos_ = kSegmentHeaderSize;
+    return true;
+}
+
+void CaptureReader::Close() {
+    Platform::UnmapFile(map_);
+    seg_ = SegmentHeader();
+    pos_ = 0;
+    truncated_ = false;
+}
+
+bool CaptureReader::Next(RecordView& out) {
+    if (!map_.data || pos_ >= map_.size) return false;
+
+    const uint8_t* p = map_.data + pos_;
+    const size_t remain = map_.size - pos_;
+    // A writer killed mid-record leaves a short tail; stop there.
+    if (!DecodeRecordHeader(p, remain, out.hdr) || out.hdr.BodySize() > remain - kRecordHeaderSize) {
+        truncated_ = true;
+        return false;
+    }
+    out.head = p + kRecordHeaderSize;
+    out.payload = out.head + out.hdr.headLen;
+    pos_ += out.hdr.RecordSize();
+    return true;
+}
+
+std::vector<fs::path> ListCaptureSegments(const fs::path& path) {
+    std::vector<fs::path> out;
+    std::error_code ec;
+    if (fs::is_directory(path, ec)) {
+        for (const auto& e : fs::directory_iterator(path, ec)) {
+            if (e.is_regular_file(ec) && e.path().extension() == ".enscap")
+                out.push_back(e.path());
+        }
+        // capture_<session>_<segment>: sort numerically on both parts.
+        std::sort(out.begin(), out.end(), [](const fs::path& a, const fs::path& b) {
+            const std::string sa = a.filename().string(), sb = b.filename().string();
+            return sa.size() != sb.size() ? sa.size() < sb.size() : sa < sb;
+        });
+    }
+    else if (fs::exists(path, ec)) {
+        out.push_back(path);
+    }
+    return out;
+}
+
+bool ReplaySource::NextStored(RecordView& out) {
+    for (;;) {
+        if (readerOpen_ && reader_.Next(out)) {
+            ++stats_.records;
+            stats_.bytes += out.hdr.RecordSize();
+            return true;
+        }
+        if (readerOpen_) {
+            if (reader_.Truncated()) ++stats_.truncatedSegments;
+            reader_.Close();
+            readerOpen_ = false;
+        }
+        if (nextSegment_ >= segments_.size()) return false;
+
+        readerOpen_ = reader_.Open(segments_[nextSegment_++]);
+        if (readerOpen_) {
+            stats_.bytes += kSegmentHeaderSize;
+            // Key state belongs to a session; segments of a new one start clean.
+            if (reader_.Segment().sessionId != sessionId_) {
+                sessionId_ = reader_.Segment().sessionId;
+                decoders_.clear();
+                lastRawIndex_ = 0;
+            }
+            pendingIndex_ = RecordView();
+        }
+    }
+}
+
+bool ReplaySource::Next(RecordView& out) {
+    RecordView rv;
+    while (NextStored(rv)) {
+        if (rv.hdr.flags & kRecordFieldIndex) {
+            ++stats_.indexRecords;
+            pendingIndex_ = rv;
+            continue;
+        }
+        if (!(rv.hdr.flags & kRecordRaw)) {
+            // The live decode of a frame we also have raw: superseded.
+            if (lastRawIndex_ != 0 && rv.hdr.index == lastRawIndex_) continue;
+            if (rv.hdr.flags & kRecordCompressed) {
+                ++stats_.compressedRecords;
+                if (!DecompressPayload(rv.hdr, rv.head, dicts_, inflated_)) {
+                    ++stats_.inflateErrors;
+                    pendingIndex_ = RecordView();
+                    continue;
+                }
+                rv.payload = inflated_.data();
+            }
+            out = rv;
+            if (pendingIndex_.payload && pendingIndex_.hdr.index == rv.hdr.index) {
+                out.fieldIndex = pendingIndex_.payload;
+                out.fieldCount = uint32_t(pendingIndex_.hdr.payloadLen / kProtoFieldSize);
+            }
+            pendingIndex_ = RecordView();
+            return true;
+        }
+
+        ++stats_.rawRecords;
+        lastRawIndex_ = rv.hdr.index;
+
+        // Old raw records carry no session head: one connection, numbered
+        // by record index.
+        uint64_t peerSession = 0, sessionIndex = rv.hdr.index;
+        DecodeRawSessionHead(rv.head, rv.hdr.headLen, peerSession, sessionIndex);
+
+        RecordHeader rec;
+        rec.direction = rv.hdr.direction;
+        rec.index = rv.hdr.index;
+        rec.timestampNs = rv.hdr.timestampNs;
+        PacketDecoder& decoder = decoders_[peerSession];
+        DecodeResult r = decoder.Decode(rv.payload, rv.hdr.payloadLen, sessionIndex, rec, decoded_);
+        if (r.status != FrameStatus::Ok) {
+            ++stats_.frameErrors;
+            continue;
+        }
+        ++stats_.decoded;
+        out.hdr = rec;
+        out.head = decoded_.data() + kRecordHeaderSize;
+        out.payload = out.head + rec.headLen;
+        out.fieldIndex = nullptr;
+        out.fieldCount = 0;
+        out.peerSession = peerSession;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,106 @@
+#include "CaptureWriter.h"
+#include "PacketNames.h"
+
+#include <cstdio>
+
+namespace fs = std::filesystem;
+
+fs::path CaptureWriter::SegmentPath(const fs::path& dir, uint64_t sessionId, uint32_t segment) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "capture_%llu_%05u.enscap",
+        (unsigned long long)sessionId, (unsigned)segment);
+    return dir / name;
+}
+
+bool CaptureWriter::Open(const fs::path& dir, uint64_t sessionId, uint64_t maxSegmentBytes) {
+    Close();
+    dir_ = dir;
+    sessionId_ = sessionId;
+    maxSegmentBytes_ = maxSegmentBytes;
+    segmentIndex_ = 0;
+    records_ = 0;
+    return OpenSegment();
+}
+
+bool CaptureWriter::OpenSegment() {
+    fh_ = Platform::CreateWriteFile(SegmentPath(dir_, sessionId_, segmentIndex_));
+    if (fh_ == Platform::kInvalidFile) return false;
+
+    SegmentHeader sh;
+    sh.sessionId = sessionId_;
+    sh.segmentIndex = segmentIndex_;
+    sh.processId = Platform::GetProcessId();
+    uint8_t buf[kSegmentHeaderSize];
+    EncodeSegmentHeader(buf, sh);
+    segmentBytes_ = kSegmentHeaderSize;
+    return Platform::WriteAll(fh_, buf, sizeof(buf));
+}
+
+bool CaptureWriter::Rotate() {
+    Platform::CloseFile(fh_);
+    fh_ = Platform::kInvalidFile;
+    ++segmentIndex_;
+    return OpenSegment();
+}
+
+bool CaptureWriter::Append(const uint8_t* record, size_t len) {
+    Platform::IoSlice slice{ record, len };
+    return AppendBatch(&slice, 1);
+}
+
+bool CaptureWriter::AppendBatch(const Platform::IoSlice* records, size_t count) {
+    if (!IsOpen()) return false;
+    size_t i = 0;
+    while (i < count) {
+        // Longest run that fits the current segment. Rotation happens on a
+        // record boundary; an oversized record still gets a segment of its own.
+        // A field index record is kept in the same segment as the record it
+        // precedes, so readers can hold on to it as a view.
+        size_t j = i;
+        uint64_t bytes = 0;
+        while (j < count) {
+            size_t unit = 1;
+            uint64_t unitBytes = records[j].len;
+            if (j + 1 < count && (static_cast<const uint8_t*>(records[j].data)[7] & kRecordFieldIndex)) {
+                unit = 2;
+                unitBytes += records[j + 1].len;
+            }
+            const uint64_t used = segmentBytes_ + bytes;
+            if (used > kSegmentHeaderSize && used + unitBytes > maxSegmentBytes_) break;
+            bytes += unitBytes;
+            j += unit;
+        }
+        if (j == i) {
+            if (!Rotate()) return false;
+            continue;
+        }
+        if (!Platform::WriteGather(fh_, records + i, j - i)) return false;
+        segmentBytes_ += bytes;
+        records_ += j - i;
+        i = j;
+    }
+    return true;
+}
+
+void CaptureWriter::Close() {
+    if (fh_ != Platform::kInvalidFile) {
+        Platform::CloseFile(fh_);
+        fh_ = Platform::kInvalidFile;
+    }
+}
+
+bool WriteLegacyPacketFile(const fs::path& dir, const RecordHeader& rec, const uint8_t* payload) {
+    const char* dirFlag = rec.direction == 0 ? "CS" : "SC";
+    const std::string_view name = PacketIdToName(rec.cmdId);
+
+    char fname[128];
+    if (!name.empty()) {
+        std::snprintf(fname, sizeof(fname), "%llu_%s_%.*s.bin",
+            (unsigned long long)rec.index, dirFlag, int(name.size()), name.data());
+    }
+    else {
+        std::snprintf(fname, sizeof(fname), "%llu_%s_Cmd_%u.bin",
+            (unsigned long long)rec.index, dirFlag, (unsigned)rec.cmdId);
+    }
+    return Platform::WriteWholeFile(dir / fname, payload, rec.payloadLen);
+}
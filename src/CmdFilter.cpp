@@ -0,0 +1,196 @@
+#include "CmdFilter.h"
+#include "PacketNames.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+static inline std::string Trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return std::string();
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+static inline bool ParseId(const std::string& s, uint16_t& out) {
+    if (s.empty() || s.size() > 5) return false;
+    uint32_t v = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + uint32_t(c - '0');
+    }
+    if (v == 0 || v > UINT16_MAX) return false;
+    out = uint16_t(v);
+    return true;
+}
+
+static inline void SetBit(uint64_t* bits, uint16_t cmdId) {
+    bits[cmdId >> 6] |= uint64_t(1) << (cmdId & 63);
+}
+
+// Comma separated, optionally CS:/SC: prefixed cmd names or ids, into one
+// bit set per direction. Returns the number of items, 0 on a bad item.
+size_t CmdFilter::ParseCmds(const std::string& list, uint64_t (*out)[kWords]) {
+    size_t count = 0;
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) end = list.size();
+        std::string item = Trim(list.substr(pos, end - pos));
+        pos = end + 1;
+        if (item.empty()) continue;
+
+        bool dir[2] = { true, true };
+        if (item.size() > 3 && item[2] == ':') {
+            const std::string prefix = item.substr(0, 2);
+            if (prefix == "CS") dir[size_t(PacketSource::Server)] = false;
+            else if (prefix == "SC") dir[size_t(PacketSource::Client)] = false;
+            else return 0;
+            item = Trim(item.substr(3));
+        }
+        uint16_t id = 0;
+        if (!ParseId(item, id) && (id = PacketNameToId(item)) == 0) return 0;
+        for (size_t d = 0; d < 2; ++d)
+            if (dir[d]) SetBit(out[d], id);
+        ++count;
+    }
+    return count;
+}
+
+static std::atomic<uint64_t> g_nextFilterId{ 1 };
+
+CmdFilter::CmdFilter() : id_(g_nextFilterId.fetch_add(1)) {
+    std::memset(allow_, 0, sizeof(allow_));
+    std::memset(deny_, 0, sizeof(deny_));
+    Compile();
+}
+
+void CmdFilter::Compile() {
+    for (size_t d = 0; d < 2; ++d)
+        for (size_t w = 0; w < kWords; ++w)
+            bits_[d][w] = (anyAllow_ ? allow_[d][w] : ~uint64_t(0)) & ~deny_[d][w];
+}
+
+bool CmdFilter::ParseLine(const std::string& text) {
+    const std::string line = Trim(text);
+    const size_t sp = line.find_first_of(" \t");
+    const std::string verb = line.substr(0, sp);
+    uint64_t (*target)[kWords];
+    if (verb == "allow") target = allow_;
+    else if (verb == "deny") target = deny_;
+    else if (verb == "sample") return sp != std::string::npos && ParseSample(line.substr(sp + 1));
+    else return false;
+    const std::string list = sp == std::string::npos ? std::string() : line.substr(sp + 1);
+
+    // Parse the whole rule before applying any of it.
+    uint64_t pending[2][kWords] = {};
+    if (ParseCmds(list, pending) == 0) return false;
+
+    for (size_t d = 0; d < 2; ++d)
+        for (size_t w = 0; w < kWords; ++w) target[d][w] |= pending[d][w];
+    if (target == allow_) anyAllow_ = true;
+    Compile();
+    return true;
+}
+
+// `<cmds> every N`, `<cmds> rate N[/B]` or `<cmds> first N`.
+bool CmdFilter::ParseSample(const std::string& rest) {
+    const std::string text = Trim(rest);
+    const size_t valueAt = text.find_last_of(" \t");
+    if (valueAt == std::string::npos) return false;
+    const std::string head = Trim(text.substr(0, valueAt));
+    const size_t modeAt = head.find_last_of(" \t");
+    if (modeAt == std::string::npos) return false;
+
+    Sampler rule;
+    const std::string mode = head.substr(modeAt + 1);
+    if (mode == "every") rule.mode = SampleMode::Every;
+    else if (mode == "rate") rule.mode = SampleMode::Rate;
+    else if (mode == "first") rule.mode = SampleMode::First;
+    else return false;
+
+    std::string value = text.substr(valueAt + 1);
+    uint16_t n = 0, burst = 0;
+    const size_t slash = value.find('/');
+    if (slash != std::string::npos) {
+        if (rule.mode != SampleMode::Rate || !ParseId(value.substr(slash + 1), burst)) return false;
+        value.resize(slash);
+    }
+    if (!ParseId(value, n)) return false;
+    rule.n = n;
+    rule.burst = burst ? burst : n;
+    rule.tokens = rule.burst;
+
+    uint64_t cmds[2][kWords] = {};
+    if (ParseCmds(Trim(head.substr(0, modeAt)), cmds) == 0) return false;
+
+    if (slotOf_.empty()) slotOf_.assign(2 * kWords * 64, 0);
+    for (size_t d = 0; d < 2; ++d) {
+        for (size_t cmd = 0; cmd <= UINT16_MAX; ++cmd) {
+            if (!((cmds[d][cmd >> 6] >> (cmd & 63)) & 1)) continue;
+            uint32_t& slot = slotOf_[d << 16 | cmd];
+            if (slot) {
+                samples_[slot - 1] = rule;
+            }
+            else {
+                samples_.push_back(rule);
+                slot = uint32_t(samples_.size());
+            }
+        }
+    }
+    return true;
+}
+
+bool CmdFilter::Keep(uint32_t slot, uint64_t timestampNs, SessionSamples& session) {
+    Sampler& s = samples_[slot];
+    switch (s.mode) {
+    case SampleMode::Every:
+        return s.count++ % s.n == 0;
+    case SampleMode::Rate: {
+        if (s.lastNs && timestampNs > s.lastNs) {
+            s.tokens += double(timestampNs - s.lastNs) * s.n / 1e9;
+            if (s.tokens > s.burst) s.tokens = s.burst;
+        }
+        if (timestampNs > s.lastNs) s.lastNs = timestampNs;
+        if (s.tokens < 1) return false;
+        s.tokens -= 1;
+        return true;
+    }
+    case SampleMode::First:
+        if (session.filterId != id_) {
+            session.filterId = id_;
+            session.seen.assign(samples_.size(), 0);
+        }
+        return session.seen[slot] < s.n && ++session.seen[slot];
+    }
+    return true;
+}
+
+bool CmdFilter::Load(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        const size_t c = line.find('#');
+        if (c != std::string::npos) line.resize(c);
+        if (Trim(line).empty()) continue;
+        if (!ParseLine(line)) {
+            std::printf("[CmdFilter] %s:%d: ignoring '%s'\n",
+                path.filename().string().c_str(), lineNo, Trim(line).c_str());
+        }
+    }
+    return true;
+}
+
+size_t CmdFilter::Passing(PacketSource src) const {
+    size_t n = 0;
+    for (size_t w = 0; w < kWords; ++w) {
+        uint64_t x = Bits(src)[w];
+        for (; x; x &= x - 1) ++n;
+    }
+    return n;
+}
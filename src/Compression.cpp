@@ -0,0 +1,275 @@
+#include "Compression.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unordered_set>
+
+#if SNIFFER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+static constexpr uint8_t kDictMagic[8] = { 'E', 'N', 'S', 'D', 'I', 'C', 'T', '1' };
+
+// Plain payloads are bounded like everything else we parse.
+static constexpr uint32_t kMaxPlainPayload = 256u << 20;
+
+// Trainer: samples kept per cmd, in multiples of the dictionary size, and
+// the fewest samples worth a dictionary.
+static constexpr size_t kKeepFactor = 8;
+static constexpr size_t kMinSamples = 4;
+
+const char* CodecName(Codec c) {
+    switch (c) {
+    case Codec::None: return "none";
+    case Codec::Lz4:  return "lz4";
+    case Codec::Zstd: return "zstd";
+    default:          return "?";
+    }
+}
+
+bool ParseCodec(const std::string& name, Codec& out) {
+    if (name == "none") out = Codec::None;
+    else if (name == "lz4") out = Codec::Lz4;
+    else if (name == "zstd") out = Codec::Zstd;
+    else return false;
+    return true;
+}
+
+bool CodecAvailable(Codec c) {
+#if SNIFFER_HAVE_ZSTD
+    return c == Codec::None || c == Codec::Lz4 || c == Codec::Zstd;
+#else
+    return c == Codec::None || c == Codec::Lz4;
+#endif
+}
+
+// ---- dictionaries ---------------------------------------------------------------
+
+static uint32_t DictId(uint16_t cmdId, const std::vector<uint8_t>& bytes) {
+    uint32_t h = 2166136261u ^ cmdId;
+    for (uint8_t b : bytes) h = (h ^ b) * 16777619u;
+    return h ? h : 1;
+}
+
+DictionarySet::DictionarySet() : byCmd_(size_t(UINT16_MAX) + 1, -1) {}
+
+void DictionarySet::Add(uint16_t cmdId, std::vector<uint8_t> bytes) {
+    auto d = std::make_unique<CmdDictionary>();
+    d->cmdId = cmdId;
+    d->id = DictId(cmdId, bytes);
+    d->bytes = std::move(bytes);
+    byCmd_[cmdId] = int32_t(dicts_.size());
+    dicts_.push_back(std::move(d));
+}
+
+void DictionarySet::Prepare(int zstdLevel) {
+    for (auto& d : dicts_) {
+        Lz4PrepareDict(d->bytes.data(), d->bytes.size(), d->lz4);
+#if SNIFFER_HAVE_ZSTD
+        d->zstdC.reset(ZSTD_createCDict(d->bytes.data(), d->bytes.size(), zstdLevel),
+            [](void* p) { ZSTD_freeCDict(static_cast<ZSTD_CDict*>(p)); });
+        d->zstdD.reset(ZSTD_createDDict(d->bytes.data(), d->bytes.size()),
+            [](void* p) { ZSTD_freeDDict(static_cast<ZSTD_DDict*>(p)); });
+#else
+        (void)zstdLevel;
+#endif
+    }
+}
+
+const CmdDictionary* DictionarySet::ForCmd(uint16_t cmdId) const {
+    const int32_t i = byCmd_[cmdId];
+    return i < 0 ? nullptr : dicts_[size_t(i)].get();
+}
+
+const CmdDictionary* DictionarySet::ById(uint32_t id) const {
+    for (const auto& d : dicts_)
+        if (d->id == id) return d.get();
+    return nullptr;
+}
+
+// "ENSDICT1", u32 count, then per dictionary u16 cmd, u16 0, u32 length and
+// the bytes. Little-endian.
+bool DictionarySet::Load(const std::filesystem::path& path) {
+    FILE* f = std::fopen(path.string().c_str(), "rb");
+    if (!f) return false;
+    uint8_t hdr[12];
+    bool ok = std::fread(hdr, 1, sizeof(hdr), f) == sizeof(hdr) && !std::memcmp(hdr, kDictMagic, 8);
+    const uint32_t count = ok ? LoadLE32(hdr + 8) : 0;
+    for (uint32_t i = 0; ok && i < count; ++i) {
+        uint8_t eh[8];
+        ok = std::fread(eh, 1, sizeof(eh), f) == sizeof(eh);
+        const uint32_t len = ok ? LoadLE32(eh + 4) : 0;
+        ok = ok && len <= kLz4MaxDict;
+        std::vector<uint8_t> bytes(len);
+        ok = ok && std::fread(bytes.data(), 1, len, f) == len;
+        if (ok) Add(LoadLE16(eh), std::move(bytes));
+    }
+    std::fclose(f);
+    return ok;
+}
+
+bool DictionarySet::Save(const std::filesystem::path& path) const {
+    FILE* f = std::fopen(path.string().c_str(), "wb");
+    if (!f) return false;
+    uint8_t hdr[12];
+    std::memcpy(hdr, kDictMagic, 8);
+    StoreLE32(hdr + 8, uint32_t(dicts_.size()));
+    bool ok = std::fwrite(hdr, 1, sizeof(hdr), f) == sizeof(hdr);
+    for (const auto& d : dicts_) {
+        uint8_t eh[8];
+        StoreLE16(eh, d->cmdId);
+        StoreLE16(eh + 2, 0);
+        StoreLE32(eh + 4, uint32_t(d->bytes.size()));
+        ok = ok && std::fwrite(eh, 1, sizeof(eh), f) == sizeof(eh)
+            && std::fwrite(d->bytes.data(), 1, d->bytes.size(), f) == d->bytes.size();
+    }
+    return std::fclose(f) == 0 && ok;
+}
+
+void DictionaryTrainer::Add(uint16_t cmdId, const uint8_t* payload, size_t len) {
+    if (len < 8 || len > dictBytes_) return;
+    if (byCmd_.empty()) byCmd_.resize(size_t(UINT16_MAX) + 1);
+    Samples& s = byCmd_[cmdId];
+    ++s.seen;
+    s.seenBytes += len;
+
+    // Reservoir sample, so a long capture is represented evenly.
+    if (s.keptBytes + len <= kKeepFactor * dictBytes_) {
+        s.kept.emplace_back(payload, payload + len);
+        s.keptBytes += len;
+        return;
+    }
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 7;
+    rng_ ^= rng_ << 17;
+    const uint64_t j = rng_ % s.seen;
+    if (j < s.kept.size()) {
+        s.keptBytes = s.keptBytes - s.kept[j].size() + len;
+        s.kept[j].assign(payload, payload + len);
+    }
+}
+
+void DictionaryTrainer::Build(DictionarySet& out) const {
+    std::vector<uint16_t> cmds;
+    for (size_t c = 0; c < byCmd_.size(); ++c)
+        if (byCmd_[c].kept.size() >= kMinSamples) cmds.push_back(uint16_t(c));
+    std::sort(cmds.begin(), cmds.end(), [&](uint16_t a, uint16_t b) {
+        return byCmd_[a].seenBytes > byCmd_[b].seenBytes;
+    });
+    if (cmds.size() > maxDicts_) cmds.resize(maxDicts_);
+
+    for (uint16_t c : cmds) {
+        // Distinct samples, newest last: LZ4 and zstd both reach the end of
+        // the history most cheaply.
+        std::vector<uint8_t> bytes;
+        std::unordered_set<std::string> seen;
+        for (const auto& sample : byCmd_[c].kept) {
+            if (bytes.size() + sample.size() > dictBytes_) break;
+            if (!seen.insert(std::string(sample.begin(), sample.end())).second) continue;
+            bytes.insert(bytes.end(), sample.begin(), sample.end());
+        }
+        out.Add(c, std::move(bytes));
+    }
+}
+
+// ---- records ----------------------------------------------------------------------
+
+#if SNIFFER_HAVE_ZSTD
+struct ZstdContexts {
+    ZSTD_CCtx* c = ZSTD_createCCtx();
+    ZSTD_DCtx* d = ZSTD_createDCtx();
+    ~ZstdContexts() {
+        ZSTD_freeCCtx(c);
+        ZSTD_freeDCtx(d);
+    }
+};
+
+static ZstdContexts& ThreadZstd() {
+    thread_local ZstdContexts z;
+    return z;
+}
+#endif
+
+bool CompressRecord(const uint8_t* record, const CompressionOptions& opt, PacketBuffer& out) {
+    RecordHeader rec;
+    if (!DecodeRecordHeader(record, kRecordHeaderSize, rec)) return false;
+    if (opt.codec == Codec::None || !CodecAvailable(opt.codec) || rec.flags != 0) return false;
+    if (rec.payloadLen < opt.minBytes || rec.payloadLen <= kCompressedPayloadHeadSize + 1) return false;
+
+    const uint8_t* payload = record + kRecordHeaderSize + rec.headLen;
+    const CmdDictionary* dict = opt.dicts ? opt.dicts->ForCmd(rec.cmdId) : nullptr;
+
+    // Output must beat the plain payload, head included, or it is dropped.
+    const size_t cap = rec.payloadLen - kCompressedPayloadHeadSize - 1;
+    const size_t prefix = kRecordHeaderSize + rec.headLen + kCompressedPayloadHeadSize;
+    out = PacketBuffer::Acquire(prefix + cap);
+    uint8_t* dst = out.data() + prefix;
+
+    size_t n = 0;
+    if (opt.codec == Codec::Lz4) {
+        n = Lz4Compress(payload, rec.payloadLen, dst, cap, dict ? &dict->lz4 : nullptr);
+    }
+#if SNIFFER_HAVE_ZSTD
+    else {
+        ZstdContexts& z = ThreadZstd();
+        const size_t r = dict && dict->zstdC
+            ? ZSTD_compress_usingCDict(z.c, dst, cap, payload, rec.payloadLen, static_cast<const ZSTD_CDict*>(dict->zstdC.get()))
+            : ZSTD_compressCCtx(z.c, dst, cap, payload, rec.payloadLen, opt.level);
+        n = ZSTD_isError(r) ? 0 : r;
+    }
+#endif
+    if (n == 0) {
+        out.Release();
+        return false;
+    }
+
+    const uint32_t plainLen = rec.payloadLen;
+    rec.flags |= kRecordCompressed;
+    rec.payloadLen = uint32_t(kCompressedPayloadHeadSize + n);
+    EncodeRecordHeader(out.data(), rec);
+    std::memcpy(out.data() + kRecordHeaderSize, record + kRecordHeaderSize, rec.headLen);
+    EncodeCompressedPayloadHead(out.data() + kRecordHeaderSize + rec.headLen, uint8_t(opt.codec),
+        dict ? dict->id : 0, plainLen);
+    out.Trim(0, rec.RecordSize());
+    return true;
+}
+
+bool DecompressPayload(RecordHeader& rec, const uint8_t* body, const DictionarySet* dicts, PacketBuffer& out) {
+    const uint8_t* stored = body + rec.headLen;
+    uint8_t codec;
+    uint32_t dictId, plainLen;
+    if (!DecodeCompressedPayloadHead(stored, rec.payloadLen, codec, dictId, plainLen)) return false;
+    if (plainLen > kMaxPlainPayload || !CodecAvailable(Codec(codec))) return false;
+
+    const CmdDictionary* dict = nullptr;
+    if (dictId) {
+        dict = dicts ? dicts->ById(dictId) : nullptr;
+        if (!dict) return false;
+    }
+
+    const uint8_t* src = stored + kCompressedPayloadHeadSize;
+    const size_t srcLen = rec.payloadLen - kCompressedPayloadHeadSize;
+    out = PacketBuffer::Acquire(plainLen);
+    bool ok = false;
+    if (Codec(codec) == Codec::Lz4) {
+        ok = Lz4Decompress(src, srcLen, out.data(), plainLen,
+            dict ? dict->lz4.bytes.data() : nullptr, dict ? dict->lz4.bytes.size() : 0);
+    }
+#if SNIFFER_HAVE_ZSTD
+    else if (Codec(codec) == Codec::Zstd) {
+        ZstdContexts& z = ThreadZstd();
+        const size_t r = dict && dict->zstdD
+            ? ZSTD_decompress_usingDDict(z.d, out.data(), plainLen, src, srcLen, static_cast<const ZSTD_DDict*>(dict->zstdD.get()))
+            : ZSTD_decompressDCtx(z.d, out.data(), plainLen, src, srcLen);
+        ok = !ZSTD_isError(r) && r == plainLen;
+    }
+#endif
+    if (!ok) {
+        out.Release();
+        return false;
+    }
+    rec.flags &= uint8_t(~kRecordCompressed);
+    rec.payloadLen = plainLen;
+    return true;
+}
@@ -0,0 +1,210 @@
+#include "Config.h"
+#include "PacketNames.h"
+#include "Platform.h"
+
+#include <cstdio>
+#include <fstream>
+
+static inline std::string Trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return std::string();
+    size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+static inline bool ParseU64(const std::string& s, uint64_t& out) {
+    if (s.empty()) return false;
+    uint64_t v = 0;
+    size_t i = 0;
+    for (; i < s.size() && (unsigned)(s[i] - '0') <= 9U; ++i) {
+        uint64_t d = uint64_t(s[i] - '0');
+        if (v > (UINT64_MAX - d) / 10ULL) return false;
+        v = v * 10ULL + d;
+    }
+    if (i == 0) return false;
+    // Optional size suffix: K, M, G (binary).
+    if (i < s.size()) {
+        int shift = 0;
+        switch (s[i]) {
+        case 'k': case 'K': shift = 10; break;
+        case 'm': case 'M': shift = 20; break;
+        case 'g': case 'G': shift = 30; break;
+        default: return false;
+        }
+        if (i + 1 != s.size() || v > (UINT64_MAX >> shift)) return false;
+        v <<= shift;
+    }
+    out = v;
+    return true;
+}
+
+static inline bool ParseHex64(const std::string& s, uint64_t& out) {
+    size_t i = (s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) ? 2 : 0;
+    if (i == s.size() || s.size() - i > 16) return false;
+    uint64_t v = 0;
+    for (; i < s.size(); ++i) {
+        const char c = s[i];
+        int d;
+        if (c >= '0' && c <= '9') d = c - '0';
+        else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') d = c - 'A' + 10;
+        else return false;
+        v = (v << 4) | uint64_t(d);
+    }
+    out = v;
+    return true;
+}
+
+static inline bool ParseBool(const std::string& s, bool& out) {
+    if (s == "1" || s == "true" || s == "yes" || s == "on") { out = true; return true; }
+    if (s == "0" || s == "false" || s == "no" || s == "off") { out = false; return true; }
+    return false;
+}
+
+// Comma separated cmd names or numeric ids.
+static bool ParseCmdList(const std::string& s, std::vector<uint16_t>& out) {
+    std::vector<uint16_t> cmds;
+    size_t pos = 0;
+    while (pos <= s.size()) {
+        size_t end = s.find(',', pos);
+        if (end == std::string::npos) end = s.size();
+        const std::string item = Trim(s.substr(pos, end - pos));
+        pos = end + 1;
+        if (item.empty()) continue;
+        uint64_t id = 0;
+        if (!ParseU64(item, id)) id = PacketNameToId(item);
+        if (id == 0 || id > UINT16_MAX) return false;
+        cmds.push_back(uint16_t(id));
+    }
+    out = std::move(cmds);
+    return true;
+}
+
+static bool ApplyKey(SnifferConfig& cfg, const std::string& key, const std::string& val) {
+    if (key == "output_mode") {
+        if (val == "segments") cfg.outputMode = OutputMode::Segments;
+        else if (val == "perfile") cfg.outputMode = OutputMode::PerFile;
+        else return false;
+        return true;
+    }
+    if (key == "output_dir") {
+        if (val.empty()) return false;
+        cfg.outputDir = val;
+        return true;
+    }
+    if (key == "segment_bytes") {
+        return ParseU64(val, cfg.segmentBytes) && cfg.segmentBytes >= 4096;
+    }
+    if (key == "flush_bytes") {
+        return ParseU64(val, cfg.flushBytes) && cfg.flushBytes > 0;
+    }
+    if (key == "flush_ms") {
+        uint64_t v = 0;
+        if (!ParseU64(val, v) || v > 60000) return false;
+        cfg.flushMs = uint32_t(v);
+        return true;
+    }
+    if (key == "decode_threads") {
+        uint64_t v = 0;
+        if (!ParseU64(val, v) || v == 0 || v > 64) return false;
+        cfg.decodeThreads = uint32_t(v);
+        return true;
+    }
+    if (key == "memory_budget") {
+        return ParseU64(val, cfg.memoryBudget) && cfg.memoryBudget >= (1u << 20);
+    }
+    if (key == "overflow_policy") {
+        if (val == "block") cfg.overflowPolicy = OverflowPolicy::Block;
+        else if (val == "drop_newest") cfg.overflowPolicy = OverflowPolicy::DropNewest;
+        else if (val == "drop_oldest") cfg.overflowPolicy = OverflowPolicy::DropOldest;
+        else if (val == "drop_low_priority") cfg.overflowPolicy = OverflowPolicy::DropLowPriority;
+        else return false;
+        return true;
+    }
+    if (key == "low_priority_cmds") {
+        return ParseCmdList(val, cfg.lowPriorityCmds);
+    }
+    if (key == "compression") {
+        return ParseCodec(val, cfg.compression) && CodecAvailable(cfg.compression);
+    }
+    if (key == "compression_level") {
+        uint64_t v = 0;
+        if (!ParseU64(val, v) || v == 0 || v > 22) return false;
+        cfg.compressionLevel = int(v);
+        return true;
+    }
+    if (key == "compress_min_bytes") {
+        uint64_t v = 0;
+        if (!ParseU64(val, v) || v > UINT32_MAX) return false;
+        cfg.compressMinBytes = uint32_t(v);
+        return true;
+    }
+    if (key == "compression_dicts") {
+        cfg.compressionDicts = val;
+        return true;
+    }
+    if (key == "cmd_filter") {
+        cfg.cmdFilter = val;
+        return true;
+    }
+    if (key == "key_cache_size") {
+        uint64_t v = 0;
+        if (!ParseU64(val, v) || v == 0 || v > 65536) return false;
+        cfg.keyCacheSize = uint32_t(v);
+        return true;
+    }
+    if (key == "key_cache_file") {
+        cfg.keyCacheFile = val;
+        return true;
+    }
+    if (key == "ec2b_cache") {
+        cfg.ec2bCache = val;
+        return true;
+    }
+    if (key == "ec2b_id") {
+        return ParseHex64(val, cfg.ec2bId);
+    }
+    if (key == "capture_raw") {
+        return ParseBool(val, cfg.captureRaw);
+    }
+    if (key == "index_fields") {
+        return ParseBool(val, cfg.indexFields);
+    }
+    if (key == "track_rtt") {
+        return ParseBool(val, cfg.trackRtt);
+    }
+    return false;
+}
+
+bool LoadConfigFile(const std::filesystem::path& path, SnifferConfig& cfg) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        size_t c = line.find_first_of("#;");
+        if (c != std::string::npos) line.resize(c);
+        line = Trim(line);
+        if (line.empty()) continue;
+
+        size_t eq = line.find('=');
+        std::string key = Trim(line.substr(0, eq));
+        std::string val = eq == std::string::npos ? std::string() : Trim(line.substr(eq + 1));
+        if (eq == std::string::npos || !ApplyKey(cfg, key, val)) {
+            std::printf("[Config] %s:%d: ignoring '%s'\n",
+                path.filename().string().c_str(), lineNo, line.c_str());
+        }
+    }
+    return true;
+}
+
+const SnifferConfig& GetConfig() {
+    static const SnifferConfig cfg = [] {
+        SnifferConfig c;
+        LoadConfigFile(Platform::GetBaseDir() / "EnetSniffer.ini", c);
+        return c;
+    }();
+    return cfg;
+}
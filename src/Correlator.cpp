@@ -0,0 +1,235 @@
+#include "Correlator.h"
+#include "PacketNames.h"
+#include "PacketProcessor.h"
+
+#include <algorithm>
+
+// Requests without a sequence id are keyed by cmd, outside the 32-bit
+// sequence id range.
+static constexpr uint64_t kCmdKey = 1ull << 32;
+
+static inline size_t HashKey(uint64_t session, uint64_t key) {
+    return size_t(((key ^ (session * 0xC2B2AE3D27D4EB4Full)) * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+Correlator::Correlator(size_t slots, uint64_t timeoutNs)
+    : timeoutNs_(timeoutNs), lastSeqByCmd_(kPacketNameTableSize), rtt_(kPacketNameTableSize) {
+    size_t n = 16;
+    while (n < slots) n <<= 1;
+    slots_.resize(n);
+    scratch_.resize(n);
+    mask_ = n - 1;
+}
+
+Correlator::Slot* Correlator::Find(uint64_t session, uint64_t key) {
+    for (size_t i = HashKey(session, key) & mask_;; i = (i + 1) & mask_) {
+        Slot& s = slots_[i];
+        if (s.state == SlotState::Empty) return nullptr;
+        if (s.key == key && s.session == session) return &s;
+    }
+}
+
+Correlator::Slot* Correlator::Insert(uint64_t session, uint64_t key) {
+    for (size_t i = HashKey(session, key) & mask_;; i = (i + 1) & mask_) {
+        Slot& s = slots_[i];
+        if (s.state == SlotState::Empty) {
+            ++used_;
+            s.session = session;
+            s.key = key;
+            return &s;
+        }
+        if (s.key == key && s.session == session) return &s;
+    }
+}
+
+// Rebuilds the table without answered requests and without pending ones
+// past the timeout (counted as lost). Runs when the table is 3/4 full, so
+// its cost is spread over at least a quarter of the slots' inserts.
+void Correlator::Sweep(uint64_t nowNs) {
+    slots_.swap(scratch_);
+    std::fill(slots_.begin(), slots_.end(), Slot());
+    used_ = 0;
+
+    // If nearly everything is still pending, the peer stopped answering:
+    // give those up too rather than let the table fill.
+    size_t live = 0;
+    for (const Slot& s : scratch_)
+        if (s.state == SlotState::Pending && nowNs - s.sentNs < timeoutNs_) ++live;
+    const bool dropAll = live > slots_.size() / 2;
+
+    for (const Slot& s : scratch_) {
+        if (s.state != SlotState::Pending) continue;
+        if (dropAll || nowNs - s.sentNs >= timeoutNs_) {
+            ++stats_.lost;
+            continue;
+        }
+        *Insert(s.session, s.key) = s;
+    }
+}
+
+void Correlator::EndSession(uint64_t session) {
+    std::lock_guard<std::mutex> lk(lock_);
+    slots_.swap(scratch_);
+    std::fill(slots_.begin(), slots_.end(), Slot());
+    used_ = 0;
+    for (const Slot& s : scratch_) {
+        if (s.state != SlotState::Pending) continue;
+        if (s.session == session) {
+            ++stats_.lost;
+            continue;
+        }
+        *Insert(s.session, s.key) = s;
+    }
+    marks_.erase(session);
+    marksSession_ = ~0ull;
+    marksCache_ = nullptr;
+}
+
+Correlator::SeqMarks& Correlator::Marks(uint64_t session) {
+    if (session != marksSession_) {
+        marksCache_ = &marks_[session];
+        marksSession_ = session;
+    }
+    return *marksCache_;
+}
+
+void Correlator::OnClientSeq(SeqMarks& m, uint32_t seq) {
+    if (m.lastClientSeq == 0 || seq == m.lastClientSeq + 1) {
+        m.lastClientSeq = seq;
+    }
+    else if (seq == m.lastClientSeq) {
+        ++stats_.seqDuplicates;
+    }
+    else if (seq < m.lastClientSeq) {
+        ++stats_.seqReordered;
+    }
+    else {
+        stats_.seqGaps += seq - m.lastClientSeq - 1;
+        m.lastClientSeq = seq;
+    }
+}
+
+void Correlator::OnRequest(const RecordHeader& rec, uint64_t session, uint32_t seq) {
+    ++stats_.requests;
+    if ((used_ + 1) * 4 > slots_.size() * 3) Sweep(rec.timestampNs);
+
+    Slot* s = Insert(session, seq ? uint64_t(seq) : kCmdKey | rec.cmdId);
+    if (s->state == SlotState::Pending) ++stats_.lost;  // replaced before an answer
+    s->sentNs = rec.timestampNs;
+    s->seq = seq;
+    s->reqCmd = rec.cmdId;
+    s->state = SlotState::Pending;
+    if (seq) lastSeqByCmd_[rec.cmdId] = { session, seq };
+}
+
+void Correlator::OnResponse(const RecordHeader& rec, uint64_t session, uint16_t reqCmd, uint32_t seq) {
+    ++stats_.responses;
+    Slot* s = nullptr;
+    if (seq) {
+        s = Find(session, seq);
+        if (s && s->reqCmd != reqCmd) s = nullptr;
+    }
+    const bool bySeq = s != nullptr;
+    if (!s) s = Find(session, kCmdKey | reqCmd);
+    const LatestSeq latest = lastSeqByCmd_[reqCmd];
+    if (!s && latest.seq && latest.session == session) {
+        // No usable sequence id on the response: the latest request of the
+        // pair, if it is still waiting.
+        s = Find(session, latest.seq);
+        if (s && (s->reqCmd != reqCmd || s->state != SlotState::Pending)) s = nullptr;
+    }
+
+    if (!s) {
+        ++stats_.unmatched;
+        return;
+    }
+    if (s->state == SlotState::Answered) {
+        ++stats_.duplicates;
+        return;
+    }
+
+    s->state = SlotState::Answered;
+    if (bySeq) {
+        ++stats_.matchedBySeq;
+        SeqMarks& m = Marks(session);
+        if (seq < m.lastAnsweredSeq) ++stats_.reordered;
+        else m.lastAnsweredSeq = seq;
+    }
+    else {
+        ++stats_.matchedByCmd;
+    }
+
+    auto& h = rtt_[reqCmd];
+    if (!h) h = std::make_unique<Telemetry::Histogram>();
+    h->Record(rec.timestampNs > s->sentNs ? rec.timestampNs - s->sentNs : 0);
+}
+
+void Correlator::Observe(const RecordHeader& rec, const uint8_t* head, uint64_t session) {
+    PacketHead ph;
+    DecodePacketHead(head, rec.headLen, ph);
+    Observe(rec, ph, session);
+}
+
+void Correlator::Observe(const RecordHeader& rec, const PacketHead& head, uint64_t session) {
+    std::lock_guard<std::mutex> lk(lock_);
+    const uint32_t seq = head.clientSequenceId;
+    if (rec.direction == uint8_t(PacketSource::Client)) {
+        if (seq) OnClientSeq(Marks(session), seq);
+        if (PacketRspFor(rec.cmdId)) OnRequest(rec, session, seq);
+    }
+    else if (const uint16_t req = PacketReqFor(rec.cmdId)) {
+        OnResponse(rec, session, req, seq);
+    }
+}
+
+CorrelatorStats Correlator::Stats() const {
+    std::lock_guard<std::mutex> lk(lock_);
+    CorrelatorStats st = stats_;
+    for (const Slot& s : slots_)
+        if (s.state == SlotState::Pending) ++st.pending;
+    return st;
+}
+
+std::vector<Correlator::CmdRtt> Correlator::Rtts() const {
+    std::vector<CmdRtt> out;
+    std::lock_guard<std::mutex> lk(lock_);
+    for (size_t cmd = 0; cmd < rtt_.size(); ++cmd) {
+        const Telemetry::Histogram* h = rtt_[cmd].get();
+        if (!h || !h->Count()) continue;
+        CmdRtt r;
+        r.reqCmd = uint16_t(cmd);
+        r.count = h->Count();
+        r.p50Ms = double(h->Percentile(0.50)) / 1e6;
+        r.p99Ms = double(h->Percentile(0.99)) / 1e6;
+        r.maxMs = double(h->Max()) / 1e6;
+        out.push_back(r);
+    }
+    std::sort(out.begin(), out.end(), [](const CmdRtt& a, const CmdRtt& b) {
+        return a.count != b.count ? a.count > b.count : a.reqCmd < b.reqCmd;
+    });
+    return out;
+}
+
+void Correlator::Report(FILE* out, size_t maxCmds) const {
+    const CorrelatorStats st = Stats();
+    std::fprintf(out, "requests %llu, responses %llu, matched %llu by seq + %llu by cmd, pending %llu\n",
+        (unsigned long long)st.requests, (unsigned long long)st.responses,
+        (unsigned long long)st.matchedBySeq, (unsigned long long)st.matchedByCmd,
+        (unsigned long long)st.pending);
+    std::fprintf(out, "unmatched %llu, duplicate %llu, reordered %llu, lost %llu\n",
+        (unsigned long long)st.unmatched, (unsigned long long)st.duplicates,
+        (unsigned long long)st.reordered, (unsigned long long)st.lost);
+    std::fprintf(out, "client seq: %llu skipped, %llu repeated, %llu out of order\n",
+        (unsigned long long)st.seqGaps, (unsigned long long)st.seqDuplicates,
+        (unsigned long long)st.seqReordered);
+
+    const std::vector<CmdRtt> rtts = Rtts();
+    if (rtts.empty()) return;
+    std::fprintf(out, "%-36s %10s %10s %10s %10s\n", "request", "count", "p50 ms", "p99 ms", "max ms");
+    for (size_t i = 0; i < rtts.size() && i < maxCmds; ++i) {
+        const CmdRtt& r = rtts[i];
+        const std::string_view name = PacketIdToName(r.reqCmd);
+        std::fprintf(out, "%-36.*s %10llu %10.2f %10.2f %10.2f\n", int(name.size()), name.data(),
+            (unsigned long long)r.count, r.p50Ms, r.p99Ms, r.maxMs);
+    }
+}
@@ -0,0 +1,72 @@
+#include "CpuFeatures.h"
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_IS_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define CPU_IS_X86 0
+#endif
+
+#if CPU_IS_X86
+static void CpuId(uint32_t leaf, uint32_t sub, uint32_t r[4]) {
+#if defined(_MSC_VER)
+    int regs[4];
+    __cpuidex(regs, int(leaf), int(sub));
+    for (int i = 0; i < 4; ++i) r[i] = uint32_t(regs[i]);
+#else
+    __cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+#endif
+}
+
+static uint64_t XGetBv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (uint64_t(edx) << 32) | eax;
+#endif
+}
+#endif
+
+static CpuFeatures DetectCpuFeatures() {
+    CpuFeatures f;
+#if CPU_IS_X86
+    uint32_t r[4];
+    CpuId(0, 0, r);
+    const uint32_t maxLeaf = r[0];
+
+    CpuId(1, 0, r);
+    f.sse2 = (r[3] >> 26) & 1;
+    f.ssse3 = (r[2] >> 9) & 1;
+    f.sse41 = (r[2] >> 19) & 1;
+    f.aesni = (r[2] >> 25) & 1;
+    const bool osxsave = (r[2] >> 27) & 1;
+    const bool avx = (r[2] >> 28) & 1;
+
+    // XCR0: bits 1-2 = SSE/AVX state, bits 5-7 = opmask/ZMM state.
+    const uint64_t xcr0 = osxsave ? XGetBv0() : 0;
+    const bool osAvx = (xcr0 & 0x6) == 0x6;
+    const bool osAvx512 = (xcr0 & 0xE6) == 0xE6;
+
+    if (maxLeaf >= 7) {
+        CpuId(7, 0, r);
+        f.avx2 = avx && osAvx && ((r[1] >> 5) & 1);
+        f.bmi2 = (r[1] >> 8) & 1;
+        f.avx512f = osAvx512 && ((r[1] >> 16) & 1);
+        f.avx512bw = f.avx512f && ((r[1] >> 30) & 1);
+    }
+#endif
+    return f;
+}
+
+const CpuFeatures& GetCpuFeatures() {
+    static const CpuFeatures f = DetectCpuFeatures();
+    return f;
+}
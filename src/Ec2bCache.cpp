@@ -0,0 +1,158 @@
+#include "Ec2bCache.h"
+#include "CaptureFormat.h"
+#include "Config.h"
+#include "Platform.h"
+#include "ec2b.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <thread>
+
+// File layout: 8-byte magic, then { u64 blob hash (LE), 4096 pad bytes }.
+static constexpr char kPadFileMagic[8] = { 'E', 'N', 'S', 'E', 'C', '2', 'B', '1' };
+static constexpr size_t kPadRecordSize = 8 + kEc2bXorpadSize;
+
+uint64_t Ec2bBlobHash(const uint8_t* blob, size_t len) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= blob[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+static inline bool IsRawBlob(const uint8_t* data, size_t len) {
+    return len == kEc2bBlobSize && std::memcmp(data, "Ec2b", 4) == 0;
+}
+
+bool ParseEc2bBlob(const uint8_t* data, size_t len, std::vector<uint8_t>& blob) {
+    if (IsRawBlob(data, len)) {
+        blob.assign(data, data + len);
+        return true;
+    }
+    try {
+        blob = ec2b_decode_b64(reinterpret_cast<const char*>(data), len);
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    return IsRawBlob(blob.data(), blob.size());
+}
+
+bool Ec2bPadCache::Load(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return true;
+
+    char magic[sizeof(kPadFileMagic)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kPadFileMagic, sizeof(magic)) != 0)
+        return false;
+
+    std::vector<uint8_t> rec(kPadRecordSize);
+    while (in.read(reinterpret_cast<char*>(rec.data()), kPadRecordSize)) {
+        Ec2bXorpad pad;
+        std::memcpy(pad.data(), rec.data() + 8, kEc2bXorpadSize);
+        pads_[LoadLE64(rec.data())] = pad;
+    }
+    return in.gcount() == 0;
+}
+
+bool Ec2bPadCache::Save(const std::filesystem::path& path) const {
+    // Write to a temporary name first so a crash never leaves a torn cache.
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(kPadFileMagic, sizeof(kPadFileMagic));
+        for (const auto& kv : pads_) {
+            uint8_t hash[8];
+            StoreLE64(hash, kv.first);
+            out.write(reinterpret_cast<const char*>(hash), sizeof(hash));
+            out.write(reinterpret_cast<const char*>(kv.second.data()), kEc2bXorpadSize);
+        }
+        if (!out) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+const Ec2bXorpad* Ec2bPadCache::Find(uint64_t hash) const {
+    auto it = pads_.find(hash);
+    return it == pads_.end() ? nullptr : &it->second;
+}
+
+void Ec2bPadCache::Insert(uint64_t hash, const Ec2bXorpad& pad) {
+    pads_[hash] = pad;
+}
+
+size_t DeriveEc2bPads(std::vector<Ec2bJob>& jobs, Ec2bPadCache& cache, unsigned threads) {
+    std::vector<size_t> todo;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        Ec2bJob& j = jobs[i];
+        j.hash = Ec2bBlobHash(j.blob.data(), j.blob.size());
+        j.cached = cache.Find(j.hash) != nullptr;
+        j.ok = j.cached;
+        if (!j.cached) todo.push_back(i);
+    }
+
+    std::vector<Ec2bXorpad> pads(todo.size());
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&] {
+        for (size_t t; (t = next.fetch_add(1, std::memory_order_relaxed)) < todo.size();) {
+            Ec2bJob& j = jobs[todo[t]];
+            try {
+                pads[t] = derive_xorpad_from_ec2b(j.blob.data(), j.blob.size());
+                j.ok = true;
+            }
+            catch (const std::exception&) {
+                j.ok = false;
+            }
+        }
+    };
+
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    if (threads > todo.size()) threads = unsigned(todo.size());
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+
+    size_t derived = 0;
+    for (size_t t = 0; t < todo.size(); ++t) {
+        const Ec2bJob& j = jobs[todo[t]];
+        if (!j.ok) continue;
+        cache.Insert(j.hash, pads[t]);
+        ++derived;
+    }
+    return derived;
+}
+
+const Ec2bXorpad& GetEc2bXorpad() {
+    static const Ec2bXorpad* pad = []() -> const Ec2bXorpad* {
+        const SnifferConfig& cfg = GetConfig();
+        if (cfg.ec2bCache.empty()) return &ec2b_xorpad();
+
+        const std::filesystem::path path = Platform::GetBaseDir() / cfg.ec2bCache;
+        Ec2bPadCache cache;
+        if (!cache.Load(path)) {
+            std::printf("[Ec2b] %s is not an ec2b cache, using the built-in key\n", path.string().c_str());
+            return &ec2b_xorpad();
+        }
+
+        const Ec2bXorpad* found = nullptr;
+        if (cfg.ec2bId) found = cache.Find(cfg.ec2bId);
+        else if (cache.Size() == 1) found = &cache.Entries().begin()->second;
+        if (!found) {
+            std::printf("[Ec2b] no pad %016llx in %s, using the built-in key\n",
+                (unsigned long long)cfg.ec2bId, path.string().c_str());
+            return &ec2b_xorpad();
+        }
+        return new Ec2bXorpad(*found);
+    }();
+    return *pad;
+}
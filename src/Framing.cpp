@@ -0,0 +1,36 @@
+#include "Framing.h"
+#include "XorStream.h"
+
+#include <cstring>
+
+void DecodeFrameRegion(uint8_t* dst, const uint8_t* raw, size_t offset, size_t len, const Keystream& ks) {
+    if (len == 0) return;
+    const uint8_t* src = raw + offset;
+    if (ks.ec2b) {
+        XorKeystreamCopy(dst, src, len, ks.ec2b, ks.ec2bLen, offset);
+        src = dst;
+    }
+    if (ks.key) {
+        XorKeystreamCopy(dst, src, len, ks.key, ks.keyLen, offset);
+        src = dst;
+    }
+    if (src != dst) std::memcpy(dst, src, len);
+}
+
+FrameStatus DecodeFrameHeader(const uint8_t* raw, size_t len, const Keystream& ks, FrameHeader& out) {
+    if (len < kFrameHeaderSize + kFrameTrailerSize) return FrameStatus::TooShort;
+
+    uint8_t hdr[kFrameHeaderSize];
+    DecodeFrameRegion(hdr, raw, 0, kFrameHeaderSize, ks);
+    if (ReadBE16(hdr) != kFrameMagic) return FrameStatus::BadMagic;
+
+    out.cmdId = ReadBE16(hdr + 2);
+    out.headLen = ReadBE16(hdr + 4);
+    out.payloadLen = ReadBE32(hdr + 6);
+    if (out.payloadLen > len || out.FrameSize() > len) return FrameStatus::BadLength;
+
+    uint8_t tail[kFrameTrailerSize];
+    DecodeFrameRegion(tail, raw, out.FrameSize() - kFrameTrailerSize, kFrameTrailerSize, ks);
+    if (ReadBE16(tail) != kFrameTrailer) return FrameStatus::BadTrailer;
+    return FrameStatus::Ok;
+}
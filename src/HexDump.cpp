@@ -0,0 +1,41 @@
+#include "HexDump.h"
+
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+
+std::string to_hex(const uint8_t* data, size_t len, bool with_ascii) {
+    std::ostringstream oss;
+    oss.setf(std::ios::uppercase);
+    size_t bytes_per_line = 16;
+
+    for (size_t i = 0; i < len; ++i) {
+        if ((i % bytes_per_line) == 0) {
+            if (i) oss << "\n";
+        }
+        oss << std::setw(2) << std::setfill('0') << std::hex << (unsigned)data[i] << ' ';
+
+        if (with_ascii && ((i + 1) % bytes_per_line) == 0) {
+            oss << " |";
+            for (size_t j = i + 1 - bytes_per_line; j <= i; ++j) {
+                unsigned char c = data[j];
+                oss << (std::isprint(c) ? char(c) : '.');
+            }
+            oss << '|';
+        }
+    }
+
+    if (with_ascii && (len % bytes_per_line) != 0) {
+        size_t rem = len % bytes_per_line;
+        for (size_t k = rem; k < bytes_per_line; ++k) oss << "   ";
+        if (rem <= 8) oss << ' ';
+        oss << " |";
+        for (size_t j = len - rem; j < len; ++j) {
+            unsigned char c = data[j];
+            oss << (std::isprint(c) ? char(c) : '.');
+        }
+        oss << '|';
+    }
+
+    return oss.str();
+}
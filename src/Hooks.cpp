@@ -1,13 +1,15 @@
 #include "Hooks.h"
 #include "MinHook.h"
+#include "Telemetry.h"
 #include <windows.h>
-#include <vector>
 
 using fn_enet_peer_send = int(__cdecl*)(void* peer, uint8_t channelID, ENetPacket* pkt);
 using fn_enet_peer_receive = ENetPacket * (__cdecl*)(void* peer, uint8_t* outChannelID);
+using fn_enet_peer_reset = void(__cdecl*)(void* peer);
 
 static fn_enet_peer_send    o_enet_peer_send = nullptr;
 static fn_enet_peer_receive o_enet_peer_receive = nullptr;
+static fn_enet_peer_reset   o_enet_peer_reset = nullptr;
 
 static FARPROC FindExport(const char* name) {
     HMODULE enet = GetModuleHandleA("enet.dll");
@@ -17,27 +19,32 @@ static FARPROC FindExport(const char* name) {
     return GetProcAddress(GetModuleHandleA(nullptr), name);
 }
 
-static inline void ProcessPacketIfAny(ENetPacket* p, PacketSource src) {
+static inline void ProcessPacketIfAny(void* peer, ENetPacket* p, PacketSource src) {
     if (!p || !p->data || p->dataLength == 0) return;
-    std::vector<uint8_t> buf;
-    buf.resize(p->dataLength);
-    memcpy(buf.data(), p->data, p->dataLength);
-    PacketProcessor::Process(buf, src);
+    Telemetry::Scope detour(Telemetry::Stage::Detour);
+    PacketProcessor::Process(peer, static_cast<const uint8_t*>(p->data), p->dataLength, src);
 }
 
 static int __cdecl hk_enet_peer_send(void* peer, uint8_t channelID, ENetPacket* pkt) {
-    ProcessPacketIfAny(pkt, PacketSource::Client);
+    ProcessPacketIfAny(peer, pkt, PacketSource::Client);
     return o_enet_peer_send ? o_enet_peer_send(peer, channelID, pkt) : 0;
 }
 
 static ENetPacket* __cdecl hk_enet_peer_receive(void* peer, uint8_t* outChannelID) {
     ENetPacket* pkt = o_enet_peer_receive ? o_enet_peer_receive(peer, outChannelID) : nullptr;
     if (pkt) {
-        ProcessPacketIfAny(pkt, PacketSource::Server);
+        ProcessPacketIfAny(peer, pkt, PacketSource::Server);
     }
     return pkt;
 }
 
+// ENet resets a peer on disconnect and reuses the struct for the next
+// connection, so its session ends here.
+static void __cdecl hk_enet_peer_reset(void* peer) {
+    PacketProcessor::ResetPeer(peer);
+    if (o_enet_peer_reset) o_enet_peer_reset(peer);
+}
+
 namespace Hooks {
 
     bool Initialize() {
@@ -48,6 +55,7 @@ namespace Hooks {
         Item items[] = {
             { "enet_peer_send",      (LPVOID)&hk_enet_peer_send,      (LPVOID*)&o_enet_peer_send },
             { "enet_peer_receive",   (LPVOID)&hk_enet_peer_receive,   (LPVOID*)&o_enet_peer_receive },
+            { "enet_peer_reset",     (LPVOID)&hk_enet_peer_reset,     (LPVOID*)&o_enet_peer_reset },
         };
 
         bool any = false;
@@ -64,6 +72,9 @@ namespace Hooks {
     void Uninitialize() {
         MH_DisableHook(MH_ALL_HOOKS);
         MH_Uninitialize();
+        // Runs under the loader lock with the other threads already gone:
+        // no shutdown and no reports here, they take locks a killed thread
+        // may hold. The console prints them on Enter.
         //PacketProcessor::_InternalShutdown();
     }
 
@@ -0,0 +1,135 @@
+#include "KeyCache.h"
+#include "CaptureFormat.h"
+#include "Config.h"
+#include "Platform.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// File layout: 8-byte magic, then { u64 seed (LE), kSessionKeySize key bytes }
+// records appended in derivation order. Later records win.
+static constexpr char kKeyFileMagic[8] = { 'E', 'N', 'S', 'K', 'E', 'Y', 'S', '1' };
+static constexpr size_t kKeyRecordSize = 8 + kSessionKeySize;
+
+static bool AppendKeyRecord(std::ofstream& out, const DerivedKey& k) {
+    uint8_t seed[8];
+    StoreLE64(seed, k.seed);
+    out.write(reinterpret_cast<const char*>(seed), sizeof(seed));
+    out.write(reinterpret_cast<const char*>(k.bytes), kSessionKeySize);
+    return bool(out);
+}
+
+KeyPtr KeyCache::Get(uint64_t seed) {
+    {
+        std::lock_guard<std::mutex> lk(lock_);
+        auto it = map_.find(seed);
+        if (it != map_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            ++stats_.hits;
+            return it->second.key;
+        }
+        ++stats_.misses;
+    }
+
+    // Derive outside the lock; a racing miss on the same seed just
+    // produces an identical key.
+    auto key = std::make_shared<DerivedKey>();
+    key->seed = seed;
+    DeriveKeyInto(seed, key->bytes);
+
+    std::lock_guard<std::mutex> lk(lock_);
+    auto it = map_.find(seed);
+    if (it != map_.end()) return it->second.key;
+    InsertLocked(key);
+    if (!file_.empty()) {
+        std::ofstream out(file_, std::ios::binary | std::ios::app);
+        if (!out || !AppendKeyRecord(out, *key))
+            std::printf("[KeyCache] cannot append to %s\n", file_.string().c_str());
+    }
+    return key;
+}
+
+void KeyCache::InsertLocked(KeyPtr key) {
+    const uint64_t seed = key->seed;
+    auto it = map_.find(seed);
+    if (it != map_.end()) {
+        it->second.key = std::move(key);
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        return;
+    }
+    if (map_.size() >= capacity_) {
+        map_.erase(lru_.back());
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+    lru_.push_front(seed);
+    map_.emplace(seed, Entry{ std::move(key), lru_.begin() });
+}
+
+bool KeyCache::RewriteLocked() {
+    std::ofstream out(file_, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(kKeyFileMagic, sizeof(kKeyFileMagic));
+    // Oldest first so a reload rebuilds the same recency order.
+    for (auto it = lru_.rbegin(); it != lru_.rend(); ++it)
+        if (!AppendKeyRecord(out, *map_[*it].key)) return false;
+    return true;
+}
+
+bool KeyCache::Attach(const std::filesystem::path& path) {
+    std::lock_guard<std::mutex> lk(lock_);
+    file_ = path;
+
+    size_t records = 0;
+    bool valid = false;
+    std::ifstream in(path, std::ios::binary);
+    if (in) {
+        char magic[sizeof(kKeyFileMagic)];
+        valid = in.read(magic, sizeof(magic)) && !std::memcmp(magic, kKeyFileMagic, sizeof(magic));
+        std::vector<uint8_t> rec(kKeyRecordSize);
+        while (valid && in.read(reinterpret_cast<char*>(rec.data()), kKeyRecordSize)) {
+            auto key = std::make_shared<DerivedKey>();
+            key->seed = LoadLE64(rec.data());
+            std::memcpy(key->bytes, rec.data() + 8, kSessionKeySize);
+            InsertLocked(std::move(key));
+            ++records;
+        }
+        // A torn tail would misalign later appends.
+        if (in.gcount() != 0) valid = false;
+        in.close();
+    }
+
+    // Start a fresh file if there was none, it was foreign or torn, or it
+    // has outgrown the cache.
+    if (!valid || records > capacity_) {
+        if (!RewriteLocked()) {
+            std::printf("[KeyCache] cannot write %s\n", path.string().c_str());
+            file_.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t KeyCache::Size() const {
+    std::lock_guard<std::mutex> lk(lock_);
+    return map_.size();
+}
+
+KeyCacheStats KeyCache::Stats() const {
+    std::lock_guard<std::mutex> lk(lock_);
+    return stats_;
+}
+
+KeyCache& GetKeyCache() {
+    static KeyCache* cache = [] {
+        const SnifferConfig& cfg = GetConfig();
+        auto* c = new KeyCache(cfg.keyCacheSize);
+        if (!cfg.keyCacheFile.empty())
+            c->Attach(Platform::GetBaseDir() / cfg.keyCacheFile);
+        return c;
+    }();
+    return *cache;
+}
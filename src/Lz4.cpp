@@ -0,0 +1,252 @@
+#include "Lz4.h"
+
+#include <algorithm>
+#include <cstring>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static constexpr size_t kMinMatch = 4;
+static constexpr size_t kLastLiterals = 5;   // the block always ends in literals
+static constexpr size_t kMfLimit = 12;       // no match starts in the last 12 bytes
+static constexpr size_t kMaxOffset = 65535;
+static constexpr size_t kHashSize = size_t(1) << kLz4HashLog;
+
+static inline uint32_t Read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint32_t Hash(uint32_t seq) {
+    return (seq * 2654435761u) >> (32 - kLz4HashLog);
+}
+
+void Lz4PrepareDict(const uint8_t* data, size_t len, Lz4Dict& out) {
+    if (len > kLz4MaxDict) {
+        data += len - kLz4MaxDict;
+        len = kLz4MaxDict;
+    }
+    out.bytes.assign(data, data + len);
+    out.table.assign(kHashSize, 0);
+    for (size_t p = 0; p + kMinMatch <= len; ++p)
+        out.table[Hash(Read32(data + p))] = uint32_t(p + 1);
+}
+
+// Per-thread match table. Positions are stored relative to a base that
+// moves past every input, so entries of earlier calls read as out of range
+// and nothing has to be cleared between (small) inputs.
+struct MatchTable {
+    uint32_t pos[kHashSize];
+    uint32_t base = 1;
+};
+
+// Reserves `n` positions; returns the table and the base for them.
+static MatchTable& ThreadTable(size_t n, uint32_t& base) {
+    thread_local MatchTable t = [] {
+        MatchTable m;
+        std::memset(m.pos, 0, sizeof(m.pos));
+        return m;
+    }();
+    if (t.base > UINT32_MAX - 1 - n) {
+        std::memset(t.pos, 0, sizeof(t.pos));
+        t.base = 1;
+    }
+    base = t.base;
+    t.base += uint32_t(n) + 1;
+    return t;
+}
+
+// Length of the common prefix of a and b, up to `max` bytes.
+static inline size_t CommonLength(const uint8_t* a, const uint8_t* b, size_t max) {
+    size_t k = 0;
+    while (k + 8 <= max) {
+        uint64_t x, y;
+        std::memcpy(&x, a + k, 8);
+        std::memcpy(&y, b + k, 8);
+        if (x != y) {
+#if defined(_MSC_VER)
+            unsigned long bit;
+            _BitScanForward64(&bit, x ^ y);
+            return k + bit / 8;
+#else
+            return k + size_t(__builtin_ctzll(x ^ y)) / 8;
+#endif
+        }
+        k += 8;
+    }
+    while (k < max && a[k] == b[k]) ++k;
+    return k;
+}
+
+static inline uint8_t* PutLength(uint8_t* op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = uint8_t(len);
+    return op;
+}
+
+// Literals [lit, lit + litLen) followed by a match, or the final literals
+// when matchLen is 0. Returns null if it doesn't fit before `oend`.
+static inline uint8_t* PutSequence(uint8_t* op, uint8_t* oend, const uint8_t* lit, size_t litLen,
+    size_t offset, size_t matchLen) {
+    const size_t need = 1 + litLen / 255 + 1 + litLen + (matchLen ? 2 + (matchLen - kMinMatch) / 255 + 1 : 0);
+    if (size_t(oend - op) < need) return nullptr;
+
+    uint8_t* token = op++;
+    *token = uint8_t((litLen >= 15 ? 15 : litLen) << 4);
+    if (litLen >= 15) op = PutLength(op, litLen - 15);
+    if (litLen) std::memcpy(op, lit, litLen);
+    op += litLen;
+    if (!matchLen) return op;
+
+    *op++ = uint8_t(offset);
+    *op++ = uint8_t(offset >> 8);
+    const size_t ml = matchLen - kMinMatch;
+    *token |= uint8_t(ml >= 15 ? 15 : ml);
+    if (ml >= 15) op = PutLength(op, ml - 15);
+    return op;
+}
+
+size_t Lz4Compress(const uint8_t* src, size_t n, uint8_t* dst, size_t cap, const Lz4Dict* dict) {
+    uint8_t* op = dst;
+    uint8_t* const oend = dst + cap;
+    size_t anchor = 0;
+
+    const uint8_t* dictBytes = dict ? dict->bytes.data() : nullptr;
+    const size_t dictLen = dict ? dict->bytes.size() : 0;
+
+    if (n > kMfLimit) {
+        uint32_t base;
+        MatchTable& t = ThreadTable(n, base);
+        const size_t matchLimit = n - kLastLiterals;
+        size_t misses = 0;
+
+        for (size_t i = 0; i + kMfLimit <= n;) {
+            const size_t cur = i;
+            const uint32_t seq = Read32(src + i);
+            const uint32_t h = Hash(seq);
+
+            // Earlier in this input, else in the dictionary.
+            size_t offset = 0, len = 0;
+            if (t.pos[h] >= base) {
+                const size_t c = t.pos[h] - base;
+                if (i - c <= kMaxOffset && Read32(src + c) == seq) {
+                    const size_t k = i + kMinMatch + CommonLength(src + i + kMinMatch, src + c + kMinMatch,
+                        matchLimit - i - kMinMatch);
+                    size_t start = i, back = c;
+                    while (start > anchor && back > 0 && src[start - 1] == src[back - 1]) { --start; --back; }
+                    offset = i - c;
+                    len = k - start;
+                    i = start;
+                }
+            }
+            if (!len && dictLen) {
+                const uint32_t p = dict->table[h];
+                if (p && i + dictLen - (p - 1) <= kMaxOffset && Read32(dictBytes + p - 1) == seq) {
+                    const size_t d = p - 1;
+                    const size_t fromDict = std::min(matchLimit - i, dictLen - d);
+                    size_t k = i + CommonLength(src + i, dictBytes + d, fromDict);
+                    // A match running off the dictionary continues at the
+                    // start of the input.
+                    if (k - i == dictLen - d) k += CommonLength(src + k, src, matchLimit - k);
+                    size_t start = i, back = d;
+                    while (start > anchor && back > 0 && src[start - 1] == dictBytes[back - 1]) { --start; --back; }
+                    offset = i + dictLen - d;
+                    len = k - start;
+                    i = start;
+                }
+            }
+            t.pos[h] = base + uint32_t(cur);
+            if (!len) {
+                i += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            op = PutSequence(op, oend, src + anchor, i - anchor, offset, len);
+            if (!op) return 0;
+            // Index the tail of the match so the next one can chain off it.
+            const size_t end = i + len;
+            if (end >= 2 && end - 2 + kMinMatch <= n) {
+                t.pos[Hash(Read32(src + end - 2))] = base + uint32_t(end - 2);
+            }
+            i = anchor = end;
+        }
+    }
+
+    op = PutSequence(op, oend, src + anchor, n - anchor, 0, 0);
+    return op ? size_t(op - dst) : 0;
+}
+
+static inline bool GetLength(const uint8_t*& ip, const uint8_t* iend, size_t& len) {
+    uint8_t b;
+    do {
+        if (ip >= iend) return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+bool Lz4Decompress(const uint8_t* src, size_t n, uint8_t* dst, size_t outLen,
+    const uint8_t* dict, size_t dictLen) {
+    const uint8_t* ip = src;
+    const uint8_t* const iend = src + n;
+    uint8_t* op = dst;
+    uint8_t* const oend = dst + outLen;
+
+    for (;;) {
+        if (ip >= iend) return false;
+        const uint8_t token = *ip++;
+
+        size_t lit = token >> 4;
+        if (lit == 15 && !GetLength(ip, iend, lit)) return false;
+        if (lit > size_t(iend - ip) || lit > size_t(oend - op)) return false;
+        if (lit <= 16 && iend - ip >= 16 && oend - op >= 16)
+            std::memcpy(op, ip, 16);  // one fixed-size copy; the excess is overwritten later
+        else if (lit)
+            std::memcpy(op, ip, lit);
+        ip += lit;
+        op += lit;
+        if (ip == iend) return op == oend;  // last sequence: literals only
+
+        if (iend - ip < 2) return false;
+        const size_t offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+        ip += 2;
+        size_t len = token & 15;
+        if (len == 15 && !GetLength(ip, iend, len)) return false;
+        len += kMinMatch;
+        if (offset == 0 || len > size_t(oend - op)) return false;
+
+        const size_t produced = size_t(op - dst);
+        if (offset > produced) {
+            // Starts in the dictionary, may run on into the output.
+            const size_t back = offset - produced;
+            if (back > dictLen) return false;
+            const size_t fromDict = back < len ? back : len;
+            std::memcpy(op, dict + dictLen - back, fromDict);
+            op += fromDict;
+            for (size_t k = 0; k < len - fromDict; ++k) op[k] = dst[k];
+            op += len - fromDict;
+        }
+        else if (offset >= 8 && size_t(oend - op) >= len + 8) {
+            // 8 bytes at a time, possibly past the match end but not the output.
+            const uint8_t* m = op - offset;
+            for (size_t k = 0; k < len; k += 8) std::memcpy(op + k, m + k, 8);
+            op += len;
+        }
+        else if (offset >= len) {
+            std::memcpy(op, op - offset, len);
+            op += len;
+        }
+        else {
+            // Overlapping copy repeats the last `offset` bytes.
+            const uint8_t* m = op - offset;
+            for (size_t k = 0; k < len; ++k) op[k] = m[k];
+            op += len;
+        }
+    }
+}
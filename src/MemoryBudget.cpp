@@ -0,0 +1,94 @@
+#include "MemoryBudget.h"
+
+#include <chrono>
+
+void MemoryBudget::NotePeak(uint64_t now) {
+    uint64_t peak = peak_.load(std::memory_order_relaxed);
+    while (now > peak && !peak_.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+}
+
+bool MemoryBudget::TryCharge(uint64_t bytes) {
+    uint64_t cur = inFlight_.load(std::memory_order_relaxed);
+    do {
+        if (cur != 0 && cur + bytes > limit_) return false;
+    } while (!inFlight_.compare_exchange_weak(cur, cur + bytes, std::memory_order_seq_cst));
+    NotePeak(cur + bytes);
+    return true;
+}
+
+void MemoryBudget::ChargeAnyway(uint64_t bytes) {
+    NotePeak(inFlight_.fetch_add(bytes, std::memory_order_seq_cst) + bytes);
+}
+
+void MemoryBudget::WaitCharge(uint64_t bytes, void (*poke)()) {
+    if (TryCharge(bytes)) return;
+
+    const auto t0 = std::chrono::steady_clock::now();
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    for (;;) {
+        if (poke) poke();
+        if (TryCharge(bytes)) break;
+        // Credit() notifies under the lock when someone waits; the timeout
+        // only covers the poke target needing another nudge.
+        std::unique_lock<std::mutex> lk(m_);
+        cv_.wait_for(lk, std::chrono::milliseconds(1), [&] {
+            const uint64_t cur = inFlight_.load(std::memory_order_seq_cst);
+            return cur == 0 || cur + bytes <= limit_;
+        });
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+
+    blocked_.fetch_add(1, std::memory_order_relaxed);
+    blockedNs_.fetch_add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - t0).count()), std::memory_order_relaxed);
+}
+
+void MemoryBudget::Credit(uint64_t bytes) {
+    if (bytes == 0) return;
+    inFlight_.fetch_sub(bytes, std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_seq_cst) != 0) {
+        std::lock_guard<std::mutex> lk(m_);
+        cv_.notify_all();
+    }
+}
+
+void MemoryBudget::Dropped(DropReason r, uint64_t bytes) {
+    dropped_[size_t(r)].fetch_add(1, std::memory_order_relaxed);
+    droppedBytes_[size_t(r)].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+OverflowStats MemoryBudget::Stats() const {
+    OverflowStats s;
+    s.inFlight = inFlight_.load(std::memory_order_relaxed);
+    s.peak = peak_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < size_t(DropReason::Count); ++i) {
+        s.dropped[i] = dropped_[i].load(std::memory_order_relaxed);
+        s.droppedBytes[i] = droppedBytes_[i].load(std::memory_order_relaxed);
+    }
+    s.blocked = blocked_.load(std::memory_order_relaxed);
+    s.blockedNs = blockedNs_.load(std::memory_order_relaxed);
+    return s;
+}
+
+static const char* PolicyName(OverflowPolicy p) {
+    switch (p) {
+    case OverflowPolicy::Block:           return "block";
+    case OverflowPolicy::DropNewest:      return "drop_newest";
+    case OverflowPolicy::DropOldest:      return "drop_oldest";
+    case OverflowPolicy::DropLowPriority: return "drop_low_priority";
+    default:                              return "?";
+    }
+}
+
+void MemoryBudget::Report(FILE* out, OverflowPolicy policy) const {
+    const OverflowStats s = Stats();
+    const double mb = 1.0 / (1 << 20);
+    std::fprintf(out, "memory: %.1f MB in flight, peak %.1f of %.1f MB (%s)\n",
+        s.inFlight * mb, s.peak * mb, limit_ * mb, PolicyName(policy));
+    std::fprintf(out, "dropped: %llu newest (%.1f MB), %llu oldest (%.1f MB), %llu low priority (%.1f MB); "
+        "%llu captures blocked for %.1f ms\n",
+        (unsigned long long)s.dropped[size_t(DropReason::Newest)], s.droppedBytes[size_t(DropReason::Newest)] * mb,
+        (unsigned long long)s.dropped[size_t(DropReason::Oldest)], s.droppedBytes[size_t(DropReason::Oldest)] * mb,
+        (unsigned long long)s.dropped[size_t(DropReason::LowPriority)], s.droppedBytes[size_t(DropReason::LowPriority)] * mb,
+        (unsigned long long)s.blocked, s.blockedNs / 1e6);
+}
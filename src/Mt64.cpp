@@ -0,0 +1,145 @@
+#include "Mt64.h"
+#include "CpuFeatures.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BSWAP64 _byteswap_uint64
+#else
+#define BSWAP64 __builtin_bswap64
+#endif
+
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
+#define HOST_IS_LITTLE_ENDIAN 1
+#else
+#define HOST_IS_LITTLE_ENDIAN 0
+#endif
+
+static constexpr size_t kN = Mt64::kStateWords;
+static constexpr size_t kM = 156;
+static constexpr uint64_t kMatrixA = 0xB5026F5AA96619E9ULL;
+static constexpr uint64_t kUpperMask = 0xFFFFFFFF80000000ULL;
+static constexpr uint64_t kLowerMask = 0x7FFFFFFFULL;
+
+static inline uint64_t Temper(uint64_t y) {
+    y ^= (y >> 29) & 0x5555555555555555ULL;
+    y ^= (y << 17) & 0x71D67FFFEDA60000ULL;
+    y ^= (y << 37) & 0xFFF7EEE000000000ULL;
+    y ^= (y >> 43);
+    return y;
+}
+
+static inline void StoreWord(uint8_t* out, uint64_t v, Endian endian) {
+    if ((endian == Endian::Big) == bool(HOST_IS_LITTLE_ENDIAN)) v = BSWAP64(v);
+    std::memcpy(out, &v, sizeof(v));
+}
+
+// Branch-free: the low bit of y is random, so a conditional mispredicts
+// half the time.
+static inline uint64_t TwistWord(uint64_t cur, uint64_t next, uint64_t far) {
+    const uint64_t y = (cur & kUpperMask) | (next & kLowerMask);
+    return far ^ (y >> 1) ^ ((0ULL - (y & 1ULL)) & kMatrixA);
+}
+
+void Mt64Twist_Scalar(uint64_t* mt) {
+    size_t k = 0;
+    for (; k < kN - kM; ++k) mt[k] = TwistWord(mt[k], mt[k + 1], mt[k + kM]);
+    for (; k < kN - 1; ++k) mt[k] = TwistWord(mt[k], mt[k + 1], mt[k + kM - kN]);
+    mt[kN - 1] = TwistWord(mt[kN - 1], mt[0], mt[kM - 1]);
+}
+
+void Mt64Temper_Scalar(const uint64_t* mt, uint8_t* out, size_t words, Endian endian) {
+    for (size_t i = 0; i < words; ++i) StoreWord(out + i * 8, Temper(mt[i]), endian);
+}
+
+namespace {
+    struct KernelEntry {
+        Mt64Kernel kernel;
+        bool (*supported)(const CpuFeatures&);
+    };
+
+    // Ordered from most to least preferred.
+    const KernelEntry kKernels[] = {
+#if defined(SNIFFER_X86_KERNELS)
+        { { "avx2", Mt64Twist_AVX2, Mt64Temper_AVX2 }, [](const CpuFeatures& f) { return f.avx2; } },
+#endif
+        { { "scalar", Mt64Twist_Scalar, Mt64Temper_Scalar }, [](const CpuFeatures&) { return true; } },
+    };
+
+    const KernelEntry* PickKernel() {
+        const CpuFeatures& f = GetCpuFeatures();
+        for (const auto& k : kKernels)
+            if (k.supported(f)) return &k;
+        return &kKernels[sizeof(kKernels) / sizeof(kKernels[0]) - 1];
+    }
+
+    // Resolved on first use; the ec2b pad is derived during static init.
+    std::atomic<const KernelEntry*> g_kernel{ nullptr };
+
+    inline const Mt64Kernel& Kernel() {
+        const KernelEntry* k = g_kernel.load(std::memory_order_relaxed);
+        if (!k) {
+            k = PickKernel();
+            g_kernel.store(k, std::memory_order_relaxed);
+        }
+        return k->kernel;
+    }
+}
+
+void Mt64::Seed(uint64_t seed) {
+    mt_[0] = seed;
+    for (size_t i = 1; i < kN; ++i)
+        mt_[i] = 6364136223846793005ULL * (mt_[i - 1] ^ (mt_[i - 1] >> 62)) + uint64_t(i);
+    idx_ = kN;
+}
+
+uint64_t Mt64::Next() {
+    if (idx_ >= kN) {
+        Kernel().twist(mt_);
+        idx_ = 0;
+    }
+    return Temper(mt_[idx_++]);
+}
+
+void Mt64::Fill(uint8_t* out, size_t len, Endian endian) {
+    // Finish the current block word by word.
+    while (len >= 8 && idx_ < kN) {
+        StoreWord(out, Next(), endian);
+        out += 8; len -= 8;
+    }
+
+    // Whole blocks and the final partial block straight from the state.
+    const Mt64Kernel& k = Kernel();
+    while (len >= 8) {
+        k.twist(mt_);
+        size_t words = len / 8;
+        if (words > kN) words = kN;
+        k.temper(mt_, out, words, endian);
+        idx_ = words;
+        out += words * 8; len -= words * 8;
+    }
+
+    if (len) {
+        uint8_t last[8];
+        StoreWord(last, Next(), endian);
+        std::memcpy(out, last, len);
+    }
+}
+
+const char* Mt64KernelName() {
+    return Kernel().name;
+}
+
+bool ForceMt64Kernel(const char* name) {
+    const CpuFeatures& f = GetCpuFeatures();
+    for (const auto& k : kKernels) {
+        if (std::strcmp(k.kernel.name, name) == 0) {
+            if (!k.supported(f)) return false;
+            g_kernel.store(&k, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
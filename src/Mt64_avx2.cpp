@@ -0,0 +1,67 @@
+#include "Mt64.h"
+#include <immintrin.h>
+
+// Four state words per vector. The twist runs in two passes like the
+// scalar loop: words [0, 156) read only old state, words [156, 311) read
+// words that are at least 156 positions behind and therefore already
+// updated, so no vector ever depends on its own output.
+
+static inline __m256i TwistVec(__m256i cur, __m256i next, __m256i far) {
+    const __m256i upper = _mm256_set1_epi64x(int64_t(0xFFFFFFFF80000000ULL));
+    const __m256i lower = _mm256_set1_epi64x(int64_t(0x7FFFFFFFULL));
+    const __m256i matrix = _mm256_set1_epi64x(int64_t(0xB5026F5AA96619E9ULL));
+    const __m256i one = _mm256_set1_epi64x(1);
+
+    const __m256i y = _mm256_or_si256(_mm256_and_si256(cur, upper), _mm256_and_si256(next, lower));
+    const __m256i odd = _mm256_cmpeq_epi64(_mm256_and_si256(y, one), one);
+    __m256i r = _mm256_xor_si256(far, _mm256_srli_epi64(y, 1));
+    return _mm256_xor_si256(r, _mm256_and_si256(odd, matrix));
+}
+
+static inline uint64_t TwistWord(uint64_t cur, uint64_t next, uint64_t far) {
+    const uint64_t y = (cur & 0xFFFFFFFF80000000ULL) | (next & 0x7FFFFFFFULL);
+    return far ^ (y >> 1) ^ ((0ULL - (y & 1ULL)) & 0xB5026F5AA96619E9ULL);
+}
+
+void Mt64Twist_AVX2(uint64_t* mt) {
+    constexpr size_t N = Mt64::kStateWords, M = 156;
+    size_t k = 0;
+    for (; k < N - M; k += 4) {  // 156 words, exactly 39 vectors
+        const __m256i cur = _mm256_load_si256((const __m256i*)(mt + k));
+        const __m256i next = _mm256_loadu_si256((const __m256i*)(mt + k + 1));
+        const __m256i far = _mm256_load_si256((const __m256i*)(mt + k + M));
+        _mm256_store_si256((__m256i*)(mt + k), TwistVec(cur, next, far));
+    }
+    for (; k + 4 <= N - 1; k += 4) {
+        const __m256i cur = _mm256_load_si256((const __m256i*)(mt + k));
+        const __m256i next = _mm256_loadu_si256((const __m256i*)(mt + k + 1));
+        const __m256i far = _mm256_load_si256((const __m256i*)(mt + k + M - N));
+        _mm256_store_si256((__m256i*)(mt + k), TwistVec(cur, next, far));
+    }
+    _mm256_zeroupper();
+    for (; k < N - 1; ++k) mt[k] = TwistWord(mt[k], mt[k + 1], mt[k + M - N]);
+    mt[N - 1] = TwistWord(mt[N - 1], mt[0], mt[M - 1]);
+}
+
+void Mt64Temper_AVX2(const uint64_t* mt, uint8_t* out, size_t words, Endian endian) {
+    const __m256i m1 = _mm256_set1_epi64x(int64_t(0x5555555555555555ULL));
+    const __m256i m2 = _mm256_set1_epi64x(int64_t(0x71D67FFFEDA60000ULL));
+    const __m256i m3 = _mm256_set1_epi64x(int64_t(0xFFF7EEE000000000ULL));
+    const __m256i bswap = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const bool big = endian == Endian::Big;
+
+    size_t i = 0;
+    for (; i + 4 <= words; i += 4) {
+        __m256i y = _mm256_loadu_si256((const __m256i*)(mt + i));
+        y = _mm256_xor_si256(y, _mm256_and_si256(_mm256_srli_epi64(y, 29), m1));
+        y = _mm256_xor_si256(y, _mm256_and_si256(_mm256_slli_epi64(y, 17), m2));
+        y = _mm256_xor_si256(y, _mm256_and_si256(_mm256_slli_epi64(y, 37), m3));
+        y = _mm256_xor_si256(y, _mm256_srli_epi64(y, 43));
+        if (big) y = _mm256_shuffle_epi8(y, bswap);
+        _mm256_storeu_si256((__m256i*)(out + i * 8), y);
+    }
+    _mm256_zeroupper();
+    if (i < words) Mt64Temper_Scalar(mt + i, out + i * 8, words - i, endian);
+}
@@ -0,0 +1,105 @@
+#include "PacketBuffer.h"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+
+// Slab sizes. Anything above the last class is allocated directly and
+// freed on release instead of being cached.
+static constexpr size_t kSlabClasses[] = { 256, 1024, 4096, 16384, 65536, 262144 };
+static constexpr int kNumClasses = int(sizeof(kSlabClasses) / sizeof(kSlabClasses[0]));
+static constexpr size_t kSlabAlign = 64;
+// Upper bound on cached bytes per class so a burst of huge packets does not
+// pin memory forever.
+static constexpr size_t kMaxCachedBytesPerClass = 8u << 20;
+
+struct alignas(kSlabAlign) PacketSlab {
+    PacketSlab* next;
+    size_t capacity;
+    int sizeClass;
+};
+static_assert(sizeof(PacketSlab) == kSlabAlign, "slab header must keep payload aligned");
+
+static inline uint8_t* SlabBytes(PacketSlab* s) {
+    return reinterpret_cast<uint8_t*>(s + 1);
+}
+
+namespace {
+    struct SlabFreeList {
+        std::atomic_flag lock = ATOMIC_FLAG_INIT;
+        PacketSlab* head = nullptr;
+        size_t count = 0;
+
+        void Lock() { while (lock.test_and_set(std::memory_order_acquire)) {} }
+        void Unlock() { lock.clear(std::memory_order_release); }
+    };
+
+    SlabFreeList g_freeLists[kNumClasses];
+}
+
+static inline int ClassFor(size_t size) {
+    for (int c = 0; c < kNumClasses; ++c)
+        if (size <= kSlabClasses[c]) return c;
+    return kNumClasses;
+}
+
+static PacketSlab* NewSlab(size_t capacity, int sizeClass) {
+    void* mem = ::operator new(sizeof(PacketSlab) + capacity, std::align_val_t(kSlabAlign));
+    PacketSlab* s = static_cast<PacketSlab*>(mem);
+    s->next = nullptr;
+    s->capacity = capacity;
+    s->sizeClass = sizeClass;
+    return s;
+}
+
+static void DeleteSlab(PacketSlab* s) {
+    ::operator delete(static_cast<void*>(s), std::align_val_t(kSlabAlign));
+}
+
+PacketBuffer PacketBuffer::Acquire(size_t size) {
+    const int c = ClassFor(size);
+    PacketSlab* s = nullptr;
+    if (c < kNumClasses) {
+        SlabFreeList& fl = g_freeLists[c];
+        fl.Lock();
+        s = fl.head;
+        if (s) { fl.head = s->next; --fl.count; }
+        fl.Unlock();
+        if (!s) s = NewSlab(kSlabClasses[c], c);
+    }
+    else {
+        s = NewSlab(size, c);
+    }
+
+    PacketBuffer b;
+    b.slab_ = s;
+    b.data_ = SlabBytes(s);
+    b.len_ = size;
+    return b;
+}
+
+PacketBuffer PacketBuffer::CopyFrom(const void* src, size_t len) {
+    PacketBuffer b = Acquire(len);
+    if (len) std::memcpy(b.data_, src, len);
+    return b;
+}
+
+void PacketBuffer::Release() {
+    PacketSlab* s = slab_;
+    if (!s) return;
+    slab_ = nullptr; data_ = nullptr; len_ = 0;
+
+    if (s->sizeClass < kNumClasses) {
+        SlabFreeList& fl = g_freeLists[s->sizeClass];
+        const size_t maxCount = kMaxCachedBytesPerClass / kSlabClasses[s->sizeClass];
+        fl.Lock();
+        if (fl.count < maxCount) {
+            s->next = fl.head;
+            fl.head = s;
+            ++fl.count;
+            s = nullptr;
+        }
+        fl.Unlock();
+    }
+    if (s) DeleteSlab(s);
+}
@@ -0,0 +1,97 @@
+#include "PacketDecoder.h"
+#include "Ec2bCache.h"
+#include "SessionKey.h"
+#include "Telemetry.h"
+
+void PacketDecoder::PlanFor(uint64_t index, DecodePlan& plan) const {
+    plan = DecodePlan();
+    // The token exchange (first packet each way) is wrapped in the ec2b pad.
+    if (index == 1 || index == 2) {
+        plan.ks.ec2b = GetEc2bXorpad().data();
+        plan.ks.ec2bLen = kEc2bXorpadSize;
+    }
+    if (key_ && doXor_) {
+        plan.key = key_;
+        plan.ks.key = key_->bytes;
+        plan.ks.keyLen = kSessionKeySize;
+    }
+}
+
+// Cmd id of a frame under the ec2b layer alone, 0 if it doesn't decode.
+static uint16_t HandshakeCmd(const uint8_t* raw, size_t len) {
+    Keystream ks;
+    ks.ec2b = GetEc2bXorpad().data();
+    ks.ec2bLen = kEc2bXorpadSize;
+    FrameHeader fh;
+    return DecodeFrameHeader(raw, len, ks, fh) == FrameStatus::Ok ? fh.cmdId : 0;
+}
+
+bool PacketDecoder::IsSessionStart(const uint8_t* raw, size_t len) {
+    return HandshakeCmd(raw, len) == GET_PLAYER_TOKEN_REQ;
+}
+
+bool PacketDecoder::IsBarrierFrame(const uint8_t* raw, size_t len) {
+    const uint16_t cmd = HandshakeCmd(raw, len);
+    return cmd != 0 && IsBarrier(cmd);
+}
+
+FrameStatus PacketDecoder::DecodeHeader(const uint8_t* raw, size_t len, uint64_t sessionIndex, RecordHeader& rec, DecodePlan& plan) const {
+    PlanFor(sessionIndex, plan);
+
+    // Stage 1: header and trailer only; malformed frames stop here.
+    FrameHeader fh;
+    const uint64_t t0 = Telemetry::Now();
+    const FrameStatus status = DecodeFrameHeader(raw, len, plan.ks, fh);
+    Telemetry::Record(Telemetry::Stage::Framing, Telemetry::Now() - t0);
+    if (status != FrameStatus::Ok) return status;
+
+    rec.cmdId = fh.cmdId;
+    rec.flags = 0;
+    rec.headLen = fh.headLen;
+    rec.payloadLen = fh.payloadLen;
+    return status;
+}
+
+void PacketDecoder::DecodeBody(uint8_t* dst, const uint8_t* raw, const RecordHeader& rec, const DecodePlan& plan) {
+    // Stage 2: PacketHead and payload are adjacent in the frame.
+    const uint64_t t0 = Telemetry::Now();
+    DecodeFrameRegion(dst, raw, kFrameHeaderSize, rec.BodySize(), plan.ks);
+    Telemetry::Record(Telemetry::Stage::Xor, Telemetry::Now() - t0);
+}
+
+DecodeResult PacketDecoder::Commit(const RecordHeader& rec, const uint8_t* payload) {
+    DecodeResult r;
+    switch (rec.cmdId) {
+    case GET_PLAYER_TOKEN_RSP:
+        uint64_t keySeed;
+        if (ExtractSecretKeySeed(payload, rec.payloadLen, keySeed))
+            key_ = GetKeyCache().Get(keySeed);
+        r.keyInstalled = !doXor_;
+        doXor_ = true;
+        break;
+
+    default:
+        break;
+    }
+    return r;
+}
+
+DecodeResult PacketDecoder::Decode(const uint8_t* raw, size_t len, uint64_t sessionIndex, RecordHeader& rec, PacketBuffer& out) {
+    DecodeResult r;
+    DecodePlan plan;
+    r.status = DecodeHeader(raw, len, sessionIndex, rec, plan);
+    if (r.status != FrameStatus::Ok) return r;
+
+    // Decrypt straight into the slab that travels to the writer, behind
+    // room for the record header. This is the only copy of the packet.
+    out = PacketBuffer::Acquire(rec.RecordSize());
+    DecodeBody(out.data() + kRecordHeaderSize, raw, rec, plan);
+    EncodeRecordHeader(out.data(), rec);
+    r = Commit(rec, out.data() + kRecordHeaderSize + rec.headLen);
+    return r;
+}
+
+void PacketDecoder::Reset() {
+    doXor_ = false;
+    key_.reset();
+}
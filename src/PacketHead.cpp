@@ -0,0 +1,50 @@
+#include "PacketHead.h"
+#include "ProtoWire.h"
+
+bool DecodePacketHead(const uint8_t* head, size_t len, PacketHead& out) {
+    out = PacketHead();
+    const uint8_t* p = head;
+    const uint8_t* end = head + len;
+    while (p < end) {
+        uint64_t tag;
+        if (!ReadVarint(p, end, tag)) return false;
+        const uint32_t field = uint32_t(tag >> 3);
+
+        switch (tag & 7) {
+        case 0: {
+            uint64_t v;
+            if (!ReadVarint(p, end, v)) return false;
+            switch (field) {
+            case 1: out.packetId = uint32_t(v); break;
+            case 2: out.rpcId = uint32_t(v); break;
+            case 3: out.clientSequenceId = uint32_t(v); break;
+            case 4: out.enetChannelId = uint32_t(v); break;
+            case 5: out.enetIsReliable = uint32_t(v); break;
+            case 6: out.sentMs = v; break;
+            case 11: out.userId = uint32_t(v); break;
+            case 13: out.userSessionId = uint32_t(v); break;
+            case 21: out.recvTimeMs = v; break;
+            default: break;
+            }
+            break;
+        }
+        case 1:
+            if (end - p < 8) return false;
+            p += 8;
+            break;
+        case 2: {
+            size_t n;
+            if (!ReadLen(p, end, n)) return false;
+            p += n;
+            break;
+        }
+        case 5:
+            if (end - p < 4) return false;
+            p += 4;
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
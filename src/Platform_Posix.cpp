@@ -0,0 +1,115 @@
+#include "Platform.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace Platform {
+
+    std::filesystem::path GetBaseDir() {
+        std::error_code ec;
+        auto exe = std::filesystem::read_symlink("/proc/self/exe", ec);
+        if (!ec && exe.has_parent_path()) return exe.parent_path();
+        return std::filesystem::path(".");
+    }
+
+    uint32_t GetProcessId() {
+        return (uint32_t)::getpid();
+    }
+
+    FileHandle CreateWriteFile(const std::filesystem::path& path) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        return fd < 0 ? kInvalidFile : FileHandle(fd);
+    }
+
+    bool WriteAll(FileHandle h, const void* data, size_t len) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        while (len) {
+            ssize_t n = ::write(int(h), p, len);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            p += n; len -= size_t(n);
+        }
+        return true;
+    }
+
+    bool WriteGather(FileHandle h, const IoSlice* slices, size_t count) {
+        // Well under IOV_MAX everywhere; larger batches just take more calls.
+        constexpr size_t kMaxIov = 256;
+        struct iovec iov[kMaxIov];
+
+        size_t i = 0;
+        size_t skip = 0;  // bytes of slices[i] already written
+        while (i < count) {
+            size_t n = 0;
+            for (size_t j = i; j < count && n < kMaxIov; ++j, ++n) {
+                const size_t off = (j == i) ? skip : 0;
+                iov[n].iov_base = const_cast<uint8_t*>(static_cast<const uint8_t*>(slices[j].data) + off);
+                iov[n].iov_len = slices[j].len - off;
+            }
+            ssize_t wrote = ::writev(int(h), iov, int(n));
+            if (wrote < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            // Advance past fully written slices; keep the offset into a
+            // partially written one.
+            size_t left = size_t(wrote);
+            while (i < count && left >= slices[i].len - skip) {
+                left -= slices[i].len - skip;
+                skip = 0;
+                ++i;
+            }
+            skip += left;
+        }
+        return true;
+    }
+
+    void CloseFile(FileHandle h) {
+        if (h != kInvalidFile) ::close(int(h));
+    }
+
+    bool MapFileReadOnly(const std::filesystem::path& path, MappedFile& out) {
+        out = MappedFile();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        if (st.st_size == 0) {
+            ::close(fd);
+            return true;
+        }
+        void* p = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        ::madvise(p, size_t(st.st_size), MADV_SEQUENTIAL);
+
+        out.data = static_cast<const uint8_t*>(p);
+        out.size = size_t(st.st_size);
+        return true;
+    }
+
+    void UnmapFile(MappedFile& m) {
+        if (m.data) ::munmap(const_cast<uint8_t*>(m.data), m.size);
+        m = MappedFile();
+    }
+
+    bool WriteWholeFile(const std::filesystem::path& path, const uint8_t* data, size_t len) {
+        FileHandle h = CreateWriteFile(path);
+        if (h == kInvalidFile) return false;
+        bool ok = WriteAll(h, data, len);
+        CloseFile(h);
+        return ok;
+    }
+
+}
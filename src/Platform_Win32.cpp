@@ -0,0 +1,108 @@
+#include "Platform.h"
+#include <windows.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Platform {
+
+    std::filesystem::path GetBaseDir() {
+        char buf[MAX_PATH];
+        if (GetModuleFileNameA(NULL, buf, (DWORD)MAX_PATH)) {
+            std::string path(buf);
+            auto pos = path.find_last_of("\\/");
+            std::string dir = (pos != std::string::npos) ? path.substr(0, pos) : ".";
+            return std::filesystem::path(dir);
+        }
+        return std::filesystem::path(".");
+    }
+
+    uint32_t GetProcessId() {
+        return (uint32_t)::GetCurrentProcessId();
+    }
+
+    FileHandle CreateWriteFile(const std::filesystem::path& path) {
+        HANDLE h = CreateFileW(path.wstring().c_str(),
+            GENERIC_WRITE, FILE_SHARE_READ,
+            nullptr, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+            nullptr);
+        return h == INVALID_HANDLE_VALUE ? kInvalidFile : (FileHandle)h;
+    }
+
+    bool WriteAll(FileHandle h, const void* data, size_t len) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        while (len) {
+            DWORD chunk = len > 0x40000000 ? 0x40000000 : (DWORD)len;
+            DWORD wrote = 0;
+            if (!WriteFile((HANDLE)h, p, chunk, &wrote, nullptr) || wrote == 0) return false;
+            p += wrote; len -= wrote;
+        }
+        return true;
+    }
+
+    bool WriteGather(FileHandle h, const IoSlice* slices, size_t count) {
+        size_t total = 0;
+        for (size_t i = 0; i < count; ++i) total += slices[i].len;
+
+        // Reused across calls; only the writer thread gathers.
+        thread_local std::vector<uint8_t> staging;
+        staging.resize(total);
+        uint8_t* p = staging.data();
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(p, slices[i].data, slices[i].len);
+            p += slices[i].len;
+        }
+        return WriteAll(h, staging.data(), total);
+    }
+
+    void CloseFile(FileHandle h) {
+        if (h != kInvalidFile) CloseHandle((HANDLE)h);
+    }
+
+    bool MapFileReadOnly(const std::filesystem::path& path, MappedFile& out) {
+        out = MappedFile();
+        HANDLE f = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (f == INVALID_HANDLE_VALUE) return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(f, &size)) {
+            CloseHandle(f);
+            return false;
+        }
+        if (size.QuadPart == 0) {
+            CloseHandle(f);
+            return true;
+        }
+        HANDLE section = CreateFileMappingW(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(f);
+        if (!section) return false;
+
+        void* view = MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0);
+        if (!view) {
+            CloseHandle(section);
+            return false;
+        }
+        out.data = static_cast<const uint8_t*>(view);
+        out.size = (size_t)size.QuadPart;
+        out.mapping = (intptr_t)section;
+        return true;
+    }
+
+    void UnmapFile(MappedFile& m) {
+        if (m.data) UnmapViewOfFile(m.data);
+        if (m.mapping) CloseHandle((HANDLE)m.mapping);
+        m = MappedFile();
+    }
+
+    bool WriteWholeFile(const std::filesystem::path& path, const uint8_t* data, size_t len) {
+        FileHandle h = CreateWriteFile(path);
+        if (h == kInvalidFile) return false;
+        bool ok = WriteAll(h, data, len);
+        CloseFile(h);
+        return ok;
+    }
+
+}
@@ -0,0 +1,133 @@
+#include "ProtoScan.h"
+#include "CaptureFormat.h"
+#include "ProtoWire.h"
+
+namespace {
+    struct Scanner {
+        const uint8_t* base;
+        const ProtoScanLimits& limits;
+        std::vector<ProtoField>& out;
+        bool full = false;
+
+        // Appends the fields of [p, end). Returns false if the range is not
+        // a clean message; the caller rolls back what was appended.
+        bool Message(const uint8_t* p, const uint8_t* end, uint8_t depth, uint32_t parent) {
+            while (p < end) {
+                uint64_t tag;
+                if (!ReadVarint(p, end, tag)) return false;
+                const uint64_t field = tag >> 3;
+                const uint8_t wt = uint8_t(tag & 7);
+                if (field == 0 || field > 0x1FFFFFFFu) return false;
+
+                if (out.size() >= limits.maxFields) {
+                    full = true;
+                    return true;
+                }
+
+                ProtoField f{};
+                f.field = uint32_t(field);
+                f.parent = parent;
+                f.wireType = wt;
+                f.depth = depth;
+
+                switch (wt) {
+                case kWireVarint: {
+                    const uint8_t* v = p;
+                    uint64_t ignored;
+                    if (!ReadVarint(p, end, ignored)) return false;
+                    f.offset = uint32_t(v - base);
+                    f.length = uint32_t(p - v);
+                    break;
+                }
+                case kWireFixed64:
+                    if (end - p < 8) return false;
+                    f.offset = uint32_t(p - base);
+                    f.length = 8;
+                    p += 8;
+                    break;
+                case kWireFixed32:
+                    if (end - p < 4) return false;
+                    f.offset = uint32_t(p - base);
+                    f.length = 4;
+                    p += 4;
+                    break;
+                case kWireLen: {
+                    size_t len;
+                    if (!ReadLen(p, end, len)) return false;
+                    f.offset = uint32_t(p - base);
+                    f.length = uint32_t(len);
+                    p += len;
+                    break;
+                }
+                default:  // groups (3, 4) are not used by this protocol; 6, 7 are invalid
+                    return false;
+                }
+
+                const uint32_t self = uint32_t(out.size());
+                out.push_back(f);
+
+                if (wt == kWireLen && f.length && depth < limits.maxDepth) {
+                    const size_t mark = out.size();
+                    const uint8_t* body = base + f.offset;
+                    if (Message(body, body + f.length, uint8_t(depth + 1), self))
+                        out[self].flags |= kFieldMessage;
+                    else if (!full)
+                        out.resize(mark);  // just bytes
+                }
+                if (full) return true;
+            }
+            return true;
+        }
+    };
+}
+
+ProtoScanStatus ScanProto(const uint8_t* data, size_t len, std::vector<ProtoField>& out,
+    const ProtoScanLimits& limits) {
+    out.clear();
+    if (len > limits.maxBytes) return ProtoScanStatus::TooLarge;
+
+    Scanner s{ data, limits, out };
+    const bool clean = s.Message(data, data + len, 0, kNoParent);
+    if (s.full) return ProtoScanStatus::TooManyFields;
+    return clean ? ProtoScanStatus::Ok : ProtoScanStatus::Malformed;
+}
+
+const ProtoField* FindProtoField(const ProtoField* fields, size_t count, uint32_t field, uint32_t parent) {
+    for (size_t i = 0; i < count; ++i) {
+        if (fields[i].field == field && fields[i].parent == parent) return &fields[i];
+    }
+    return nullptr;
+}
+
+bool ProtoVarint(const uint8_t* base, const ProtoField& f, uint64_t& out) {
+    const uint8_t* p = base + f.offset;
+    return ReadVarint(p, p + f.length, out);
+}
+
+void EncodeProtoIndex(const ProtoField* fields, size_t count, uint8_t* out) {
+    for (size_t i = 0; i < count; ++i, out += kProtoFieldSize) {
+        const ProtoField& f = fields[i];
+        StoreLE32(out + 0, f.field);
+        StoreLE32(out + 4, f.offset);
+        StoreLE32(out + 8, f.length);
+        StoreLE32(out + 12, f.parent);
+        out[16] = f.wireType;
+        out[17] = f.depth;
+        out[18] = f.flags;
+        out[19] = 0;
+    }
+}
+
+ProtoField DecodeProtoField(const uint8_t* index, size_t i) {
+    const uint8_t* p = index + i * kProtoFieldSize;
+    ProtoField f;
+    f.field = LoadLE32(p + 0);
+    f.offset = LoadLE32(p + 4);
+    f.length = LoadLE32(p + 8);
+    f.parent = LoadLE32(p + 12);
+    f.wireType = p[16];
+    f.depth = p[17];
+    f.flags = p[18];
+    f.reserved = 0;
+    return f;
+}
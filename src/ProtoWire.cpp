@@ -0,0 +1,103 @@
+#include "ProtoWire.h"
+#include "CpuFeatures.h"
+
+#include <atomic>
+#include <cstring>
+
+size_t ReadVarints_Scalar(const uint8_t*& p, const uint8_t* end, uint64_t* out, size_t max) {
+    size_t n = 0;
+    while (n < max && p < end) {
+        const uint8_t* start = p;
+        if (!ReadVarint(p, end, out[n])) {
+            p = start;
+            break;
+        }
+        ++n;
+    }
+    return n;
+}
+
+static constexpr VarintShuffle MakeVarintShuffle() {
+    VarintShuffle t{};
+    for (unsigned m = 0; m < 128; ++m) {
+        const unsigned starts = (m << 1) | 1;
+        unsigned k = 0;
+        for (unsigned i = 0; i < 8; ++i) {
+            if (!(starts >> i & 1)) continue;
+            t.lanes[m][2 * k] = uint8_t(2 * i);
+            t.lanes[m][2 * k + 1] = uint8_t(2 * i + 1);
+            ++k;
+        }
+        for (unsigned j = 2 * k; j < 16; ++j) t.lanes[m][j] = 0x80;
+        t.count[m] = uint8_t(k);
+    }
+    return t;
+}
+
+constexpr VarintShuffle kVarintShuffle = MakeVarintShuffle();
+
+namespace {
+    struct KernelEntry {
+        const char* name;
+        VarintKernelFn fn;
+        bool (*supported)(const CpuFeatures&);
+    };
+
+    // Ordered from most to least preferred.
+    const KernelEntry kKernels[] = {
+#if defined(SNIFFER_X86_KERNELS)
+        { "avx2",   ReadVarints_AVX2,   [](const CpuFeatures& f) { return f.avx2; } },
+        { "ssse3",  ReadVarints_SSSE3,  [](const CpuFeatures& f) { return f.ssse3; } },
+#endif
+        { "scalar", ReadVarints_Scalar, [](const CpuFeatures&) { return true; } },
+    };
+
+    const KernelEntry* PickKernel() {
+        const CpuFeatures& f = GetCpuFeatures();
+        for (const auto& k : kKernels)
+            if (k.supported(f)) return &k;
+        return &kKernels[sizeof(kKernels) / sizeof(kKernels[0]) - 1];
+    }
+
+    std::atomic<const KernelEntry*> g_kernel{ nullptr };
+
+    inline const KernelEntry* Kernel() {
+        const KernelEntry* k = g_kernel.load(std::memory_order_relaxed);
+        if (!k) {
+            k = PickKernel();
+            g_kernel.store(k, std::memory_order_relaxed);
+        }
+        return k;
+    }
+}
+
+size_t ReadVarints(const uint8_t*& p, const uint8_t* end, uint64_t* out, size_t max) {
+    return Kernel()->fn(p, end, out, max);
+}
+
+bool ReadPackedVarints(const uint8_t* data, size_t len, std::vector<uint64_t>& out) {
+    // Every varint is at least one byte.
+    const size_t base = out.size();
+    out.resize(base + len);
+    const uint8_t* p = data;
+    const uint8_t* end = data + len;
+    const size_t n = ReadVarints(p, end, out.data() + base, len);
+    out.resize(base + n);
+    return p == end;
+}
+
+const char* VarintKernelName() {
+    return Kernel()->name;
+}
+
+bool ForceVarintKernel(const char* name) {
+    const CpuFeatures& f = GetCpuFeatures();
+    for (const auto& k : kKernels) {
+        if (std::strcmp(k.name, name) == 0) {
+            if (!k.supported(f)) return false;
+            g_kernel.store(&k, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,48 @@
+#include "ProtoWire.h"
+#include <immintrin.h>
+
+// As in ProtoWire_ssse3.cpp, widening with vpmovzxwq.
+static inline unsigned DecodeSmall8(__m128i b, unsigned cont, uint64_t* out, size_t& n) {
+    const __m128i low7 = _mm_set1_epi16(0x7F);
+    const __m128i lo = _mm_cvtepu8_epi16(b);
+    const __m128i next = _mm_cvtepu8_epi16(_mm_srli_si128(b, 1));
+    const __m128i more = _mm_srai_epi16(_mm_slli_epi16(lo, 8), 15);
+    const __m128i v = _mm_or_si128(_mm_and_si128(lo, low7),
+        _mm_and_si128(_mm_slli_epi16(_mm_and_si128(next, low7), 7), more));
+
+    const unsigned starts = ~(cont << 1) & 0xFF;
+    const unsigned m = starts >> 1;
+    const __m128i s = _mm_shuffle_epi8(v, _mm_load_si128((const __m128i*)kVarintShuffle.lanes[m]));
+    _mm256_storeu_si256((__m256i*)(out + n + 0), _mm256_cvtepu16_epi64(s));
+    _mm256_storeu_si256((__m256i*)(out + n + 4), _mm256_cvtepu16_epi64(_mm_srli_si128(s, 8)));
+    n += kVarintShuffle.count[m];
+    return 8 + (starts >> 7 & cont >> 7 & 1);
+}
+
+size_t ReadVarints_AVX2(const uint8_t*& p, const uint8_t* end, uint64_t* out, size_t max) {
+    const uint8_t* q = p;
+    size_t n = 0;
+    // 64-byte windows, plus 16 bytes of slack for the loads past them.
+    while (end - q >= 80 && max - n >= 64) {
+        const uint64_t cont = uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)q))))
+            | uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(q + 32))))) << 32;
+        unsigned pos = 0;
+        if ((cont & (cont << 1)) == 0) {
+            while (pos <= 48)
+                pos += DecodeSmall8(_mm_loadu_si128((const __m128i*)(q + pos)), unsigned(cont >> pos), out, n);
+        }
+        else {
+            for (uint64_t term = ~cont; term; term &= term - 1) {
+                const unsigned t = VarintCtz64(term);
+                const unsigned len = t + 1 - pos;
+                if (len > 10) break;
+                out[n++] = VarintFromBytes(q + pos, len);
+                pos = t + 1;
+            }
+        }
+        q += pos;
+        if (pos == 0) break;  // over-long varint
+    }
+    p = q;
+    return n + ReadVarints_Scalar(p, end, out + n, max - n);
+}
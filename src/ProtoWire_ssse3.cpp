@@ -0,0 +1,57 @@
+#include "ProtoWire.h"
+#include <tmmintrin.h>
+
+// Decodes the 1-2 byte varints starting in bytes [0, 8) of `b`, whose
+// continuation bits are the low bits of `cont`. Returns the bytes consumed
+// (8, or 9 when the last varint ends in byte 8).
+static inline unsigned DecodeSmall8(__m128i b, unsigned cont, uint64_t* out, size_t& n) {
+    const __m128i z = _mm_setzero_si128();
+    const __m128i low7 = _mm_set1_epi16(0x7F);
+    const __m128i lo = _mm_unpacklo_epi8(b, z);
+    const __m128i next = _mm_unpacklo_epi8(_mm_srli_si128(b, 1), z);
+    const __m128i more = _mm_srai_epi16(_mm_slli_epi16(lo, 8), 15);
+    const __m128i v = _mm_or_si128(_mm_and_si128(lo, low7),
+        _mm_and_si128(_mm_slli_epi16(_mm_and_si128(next, low7), 7), more));
+
+    const unsigned starts = ~(cont << 1) & 0xFF;
+    const unsigned m = starts >> 1;
+    const __m128i s = _mm_shuffle_epi8(v, _mm_load_si128((const __m128i*)kVarintShuffle.lanes[m]));
+    const __m128i s32lo = _mm_unpacklo_epi16(s, z);
+    const __m128i s32hi = _mm_unpackhi_epi16(s, z);
+    _mm_storeu_si128((__m128i*)(out + n + 0), _mm_unpacklo_epi32(s32lo, z));
+    _mm_storeu_si128((__m128i*)(out + n + 2), _mm_unpackhi_epi32(s32lo, z));
+    _mm_storeu_si128((__m128i*)(out + n + 4), _mm_unpacklo_epi32(s32hi, z));
+    _mm_storeu_si128((__m128i*)(out + n + 6), _mm_unpackhi_epi32(s32hi, z));
+    n += kVarintShuffle.count[m];
+    return 8 + (starts >> 7 & cont >> 7 & 1);
+}
+
+size_t ReadVarints_SSSE3(const uint8_t*& p, const uint8_t* end, uint64_t* out, size_t max) {
+    const uint8_t* q = p;
+    size_t n = 0;
+    // 64-byte windows, plus 16 bytes of slack for the loads past them.
+    while (end - q >= 80 && max - n >= 64) {
+        const uint64_t cont = uint64_t(unsigned(_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)q))))
+            | uint64_t(unsigned(_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(q + 16))))) << 16
+            | uint64_t(unsigned(_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(q + 32))))) << 32
+            | uint64_t(unsigned(_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(q + 48))))) << 48;
+        unsigned pos = 0;
+        if ((cont & (cont << 1)) == 0) {
+            while (pos <= 48)
+                pos += DecodeSmall8(_mm_loadu_si128((const __m128i*)(q + pos)), unsigned(cont >> pos), out, n);
+        }
+        else {
+            for (uint64_t term = ~cont; term; term &= term - 1) {
+                const unsigned t = VarintCtz64(term);
+                const unsigned len = t + 1 - pos;
+                if (len > 10) break;
+                out[n++] = VarintFromBytes(q + pos, len);
+                pos = t + 1;
+            }
+        }
+        q += pos;
+        if (pos == 0) break;  // over-long varint
+    }
+    p = q;
+    return n + ReadVarints_Scalar(p, end, out + n, max - n);
+}
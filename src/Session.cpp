@@ -0,0 +1,145 @@
+#include "Session.h"
+
+static inline size_t HashPeer(const void* peer) {
+    return size_t((uint64_t(uintptr_t(peer)) * 0x9E3779B97F4A7C15ull) >> 40);
+}
+
+// Peer of a removed slot: lookups probe past it, new peers may claim it.
+static const char kTombstoneMark = 0;
+static const void* const kTombstone = &kTombstoneMark;
+
+SessionTable::ReadSection::ReadSection(SessionTable& t) : table_(t) {
+    // Register under the current epoch; retry if it moved in between, so
+    // an advance never misses us.
+    for (;;) {
+        const uint64_t e = t.epoch_.load(std::memory_order_seq_cst);
+        parity_ = unsigned(e & 1);
+        t.readers_[parity_].fetch_add(1, std::memory_order_seq_cst);
+        if (t.epoch_.load(std::memory_order_seq_cst) == e) break;
+        t.readers_[parity_].fetch_sub(1, std::memory_order_release);
+    }
+}
+
+SessionTable::ReadSection::~ReadSection() {
+    table_.readers_[parity_].fetch_sub(1, std::memory_order_release);
+}
+
+SessionTable::SessionTable() : slots_(new Slot[kMaxPeers]) {}
+
+SessionTable::~SessionTable() {
+    for (size_t i = 0; i < kMaxPeers; ++i) delete slots_[i].session.load(std::memory_order_relaxed);
+    for (const Retired& r : retired_) delete r.session;
+}
+
+SessionTable::Slot* SessionTable::FindSlot(const void* peer, bool create) {
+    const size_t mask = kMaxPeers - 1;
+    Slot* reuse = nullptr;  // first removed slot on the probe path
+    for (size_t n = 0, i = HashPeer(peer) & mask; n < kMaxPeers; ++n, i = (i + 1) & mask) {
+        Slot& s = slots_[i];
+        const void* p = s.peer.load(std::memory_order_acquire);
+        if (p == peer) return &s;
+        if (p == kTombstone) {
+            if (!reuse) reuse = &s;
+            continue;
+        }
+        if (p) continue;
+        if (!create) return nullptr;
+        // Not in the table: prefer the removed slot, it shortens the probe.
+        if (reuse && ClaimSlot(*reuse, kTombstone, peer)) return reuse;
+        // Claim the empty slot; if another thread won it, it may have been
+        // for the same peer.
+        if (ClaimSlot(s, nullptr, peer)) return &s;
+    }
+    return create && reuse && ClaimSlot(*reuse, kTombstone, peer) ? reuse : nullptr;
+}
+
+bool SessionTable::ClaimSlot(Slot& slot, const void* expected, const void* peer) {
+    return slot.peer.compare_exchange_strong(expected, peer, std::memory_order_acq_rel) || expected == peer;
+}
+
+// Installs a new Session in `slot`. With `fresh` unset an existing one is
+// kept (first use race); otherwise it is replaced and retired.
+Session* SessionTable::Replace(Slot& slot, const void* peer, bool fresh) {
+    Session* cur = slot.session.load(std::memory_order_acquire);
+    if (cur && !fresh) return cur;
+
+    Session* s = new Session(nextId_.fetch_add(1, std::memory_order_relaxed), peer);
+    if (!slot.session.compare_exchange_strong(cur, s, std::memory_order_acq_rel)) {
+        // Someone else installed or replaced it first; theirs wins.
+        delete s;
+        return cur;
+    }
+    if (cur) Retire(cur);
+    return s;
+}
+
+Session* SessionTable::Get(const void* peer) {
+    Slot* slot = FindSlot(peer, true);
+    if (!slot) return nullptr;
+    Session* s = slot->session.load(std::memory_order_acquire);
+    return s ? s : Replace(*slot, peer, false);
+}
+
+Session* SessionTable::Restart(const void* peer) {
+    Slot* slot = FindSlot(peer, true);
+    return slot ? Replace(*slot, peer, true) : nullptr;
+}
+
+uint64_t SessionTable::Remove(const void* peer) {
+    Slot* slot = FindSlot(peer, false);
+    if (!slot) return 0;
+    // Free the slot for any peer; if this one connects again it most likely
+    // lands back in it.
+    Session* s = slot->session.exchange(nullptr, std::memory_order_acq_rel);
+    slot->peer.store(kTombstone, std::memory_order_release);
+    if (!s) return 0;
+    const uint64_t id = s->Id();
+    Retire(s);
+    return id;
+}
+
+void SessionTable::Retire(Session* s) {
+    std::lock_guard<std::mutex> lk(retireLock_);
+    retired_.push_back({ s, epoch_.load(std::memory_order_seq_cst) });
+    TryAdvance();
+}
+
+// Epoch E may become E+1 once no reader registered under E-1 is left; then
+// nothing retired at E-1 or earlier can still be referenced. Never waits:
+// if readers are active the retired sessions just wait for the next call.
+void SessionTable::TryAdvance() {
+    for (int step = 0; step < 2; ++step) {
+        const uint64_t e = epoch_.load(std::memory_order_seq_cst);
+        if (readers_[(e + 1) & 1].load(std::memory_order_seq_cst) != 0) break;
+
+        size_t kept = 0;
+        for (const Retired& r : retired_) {
+            if (r.epoch + 1 <= e) delete r.session;
+            else retired_[kept++] = r;
+        }
+        retired_.resize(kept);
+        epoch_.store(e + 1, std::memory_order_seq_cst);
+    }
+}
+
+void SessionTable::Report(FILE* out) {
+    ReadSection rs(*this);
+    for (size_t i = 0; i < kMaxPeers; ++i) {
+        const Session* s = slots_[i].session.load(std::memory_order_acquire);
+        if (!s) continue;
+        const SessionCounters& c = s->Counters();
+        std::fprintf(out, "session %llu peer %p: %llu out / %llu in packets, %llu / %llu bytes, %llu / %llu filtered, %llu / %llu sampled out, %llu bad frames\n",
+            (unsigned long long)s->Id(), s->Peer(),
+            (unsigned long long)c.packets[0].load(std::memory_order_relaxed),
+            (unsigned long long)c.packets[1].load(std::memory_order_relaxed),
+            (unsigned long long)c.bytes[0].load(std::memory_order_relaxed),
+            (unsigned long long)c.bytes[1].load(std::memory_order_relaxed),
+            (unsigned long long)c.filtered[0].load(std::memory_order_relaxed),
+            (unsigned long long)c.filtered[1].load(std::memory_order_relaxed),
+            (unsigned long long)c.sampledOut[0].load(std::memory_order_relaxed),
+            (unsigned long long)c.sampledOut[1].load(std::memory_order_relaxed),
+            (unsigned long long)c.frameErrors.load(std::memory_order_relaxed));
+    }
+    std::lock_guard<std::mutex> lk(retireLock_);
+    TryAdvance();
+}
@@ -0,0 +1,32 @@
+#include "SessionKey.h"
+#include "Mt64.h"
+#include "ProtoScan.h"
+
+void DeriveKeyInto(uint64_t seed, uint8_t* out) {
+    Mt64 mt(seed);
+    mt.Fill(out, kSessionKeySize, Endian::Big);
+}
+
+std::vector<uint8_t> NewKeyFromSeed(uint64_t seed) {
+    std::vector<uint8_t> key(kSessionKeySize);
+    DeriveKeyInto(seed, key.data());
+    return key;
+}
+
+bool ExtractSecretKeySeed(const uint8_t* payload, size_t payloadLen, uint64_t& secretKeySeed) {
+    // Top level only; a malformed tail still leaves the valid prefix indexed.
+    ProtoScanLimits limits;
+    limits.maxDepth = 0;
+    thread_local std::vector<ProtoField> fields;
+    ScanProto(payload, payloadLen, fields, limits);
+
+    for (const ProtoField& f : fields) {
+        if (f.field != 11) continue;
+        if (f.wireType == kWireVarint) return ProtoVarint(payload, f, secretKeySeed);
+        if (f.wireType == kWireFixed64) {
+            secretKeySeed = ProtoFixed64(payload, f);
+            return true;
+        }
+    }
+    return false;
+}
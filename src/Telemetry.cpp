@@ -0,0 +1,188 @@
+#include "Telemetry.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define TELEMETRY_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#else
+#define TELEMETRY_TSC 0
+#endif
+
+namespace Telemetry {
+
+    // Log-linear buckets: values below 16 are exact, above that each power
+    // of two is split into 16 sub-buckets (~6% relative error).
+    static constexpr int kSubBits = 4;
+    static constexpr int kSub = 1 << kSubBits;
+    static constexpr int kBuckets = (64 - kSubBits + 1) * kSub;
+    static constexpr int kStages = int(Stage::Count);
+
+    static inline int MsbIndex(uint64_t v) {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanReverse64(&idx, v);
+        return int(idx);
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+
+    static inline int BucketOf(uint64_t v) {
+        if (v < uint64_t(kSub)) return int(v);
+        const int msb = MsbIndex(v);
+        const int sub = int((v >> (msb - kSubBits)) & (kSub - 1));
+        return (msb - kSubBits + 1) * kSub + sub;
+    }
+
+    // Lower bound of the values mapped to bucket `b`.
+    static inline uint64_t BucketValue(int b) {
+        if (b < kSub) return uint64_t(b);
+        const int msb = b / kSub + kSubBits - 1;
+        const uint64_t sub = uint64_t(b % kSub);
+        return (uint64_t(1) << msb) | (sub << (msb - kSubBits));
+    }
+
+    // Lower bound of the bucket holding the rank of quantile `q`.
+    static uint64_t PercentileOf(const uint64_t* counts, uint64_t total, double q) {
+        const uint64_t rank = uint64_t(q * double(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (int b = 0; b < kBuckets; ++b) {
+            seen += counts[b];
+            if (seen >= rank) return BucketValue(b);
+        }
+        return BucketValue(kBuckets - 1);
+    }
+
+    struct ThreadHistograms {
+        std::atomic<uint64_t> counts[kStages][kBuckets];
+        std::atomic<uint64_t> max[kStages];
+
+        ThreadHistograms() {
+            for (auto& st : counts)
+                for (auto& c : st) c.store(0, std::memory_order_relaxed);
+            for (auto& m : max) m.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    namespace {
+        std::mutex g_registryLock;
+        std::vector<ThreadHistograms*> g_registry;
+
+        // Reference point for converting TSC ticks to nanoseconds at read time.
+        const uint64_t g_tick0 = Now();
+        const std::chrono::steady_clock::time_point g_clock0 = std::chrono::steady_clock::now();
+    }
+
+    static ThreadHistograms& Local() {
+        // Never freed: game threads outlive any report, and a report may run
+        // after a thread has exited.
+        thread_local ThreadHistograms* h = [] {
+            auto* p = new ThreadHistograms();
+            std::lock_guard<std::mutex> lk(g_registryLock);
+            g_registry.push_back(p);
+            return p;
+        }();
+        return *h;
+    }
+
+    const char* StageName(Stage s) {
+        switch (s) {
+        case Stage::Detour:    return "detour";
+        case Stage::Framing:   return "framing";
+        case Stage::Xor:       return "xor";
+        case Stage::QueuePush: return "queue_push";
+        case Stage::QueueWait: return "queue_wait";
+        case Stage::Compress:  return "compress";
+        case Stage::Reorder:   return "reorder";
+        case Stage::DiskWrite: return "disk_write";
+        default:               return "?";
+        }
+    }
+
+    uint64_t Now() {
+#if TELEMETRY_TSC
+        return __rdtsc();
+#else
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    void Record(Stage s, uint64_t ticks) {
+        ThreadHistograms& h = Local();
+        const int st = int(s);
+        // Single writer per histogram: plain load/store, no locked RMW.
+        auto& c = h.counts[st][BucketOf(ticks)];
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (ticks > h.max[st].load(std::memory_order_relaxed))
+            h.max[st].store(ticks, std::memory_order_relaxed);
+    }
+
+    static double NsPerTick() {
+#if TELEMETRY_TSC
+        const uint64_t ticks = Now() - g_tick0;
+        const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - g_clock0).count());
+        return ticks ? ns / double(ticks) : 0.0;
+#else
+        return 1.0;
+#endif
+    }
+
+    Summary Snapshot(Stage s) {
+        const int st = int(s);
+        std::vector<uint64_t> merged(kBuckets, 0);
+        uint64_t maxTicks = 0;
+        {
+            std::lock_guard<std::mutex> lk(g_registryLock);
+            for (ThreadHistograms* h : g_registry) {
+                for (int b = 0; b < kBuckets; ++b)
+                    merged[b] += h->counts[st][b].load(std::memory_order_relaxed);
+                const uint64_t m = h->max[st].load(std::memory_order_relaxed);
+                if (m > maxTicks) maxTicks = m;
+            }
+        }
+
+        Summary out;
+        for (uint64_t c : merged) out.count += c;
+        if (out.count == 0) return out;
+
+        const double scale = NsPerTick();
+        out.p50Ns = double(PercentileOf(merged.data(), out.count, 0.50)) * scale;
+        out.p99Ns = double(PercentileOf(merged.data(), out.count, 0.99)) * scale;
+        out.p999Ns = double(PercentileOf(merged.data(), out.count, 0.999)) * scale;
+        out.maxNs = double(maxTicks) * scale;
+        return out;
+    }
+
+    void Histogram::Record(uint64_t v) {
+        if (counts_.empty()) counts_.assign(kBuckets, 0);
+        ++counts_[BucketOf(v)];
+        ++count_;
+        if (v > max_) max_ = v;
+    }
+
+    uint64_t Histogram::Percentile(double q) const {
+        return count_ ? PercentileOf(counts_.data(), count_, q) : 0;
+    }
+
+    void Report(FILE* out) {
+        std::fprintf(out, "%-11s %12s %10s %10s %10s %12s\n",
+            "stage", "count", "p50 ns", "p99 ns", "p999 ns", "max ns");
+        for (int i = 0; i < kStages; ++i) {
+            const Summary s = Snapshot(Stage(i));
+            std::fprintf(out, "%-11s %12llu %10.0f %10.0f %10.0f %12.0f\n",
+                StageName(Stage(i)), (unsigned long long)s.count,
+                s.p50Ns, s.p99Ns, s.p999Ns, s.maxNs);
+        }
+    }
+
+}
@@ -0,0 +1,96 @@
+#include "XorStream.h"
+#include "CpuFeatures.h"
+
+#include <atomic>
+#include <cstring>
+
+void XorKernel_Scalar(uint8_t* dst, const uint8_t* src, const uint8_t* pad, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t a, b;
+        std::memcpy(&a, src + i, 8);
+        std::memcpy(&b, pad + i, 8);
+        a ^= b;
+        std::memcpy(dst + i, &a, 8);
+    }
+    for (; i < n; ++i) dst[i] = uint8_t(src[i] ^ pad[i]);
+}
+
+namespace {
+    struct KernelEntry {
+        const char* name;
+        XorKernelFn fn;
+        bool (*supported)(const CpuFeatures&);
+    };
+
+    // Ordered from most to least preferred.
+    const KernelEntry kKernels[] = {
+#if defined(SNIFFER_X86_KERNELS)
+        { "avx512", XorKernel_AVX512, [](const CpuFeatures& f) { return f.avx512f && f.avx512bw; } },
+        { "avx2",   XorKernel_AVX2,   [](const CpuFeatures& f) { return f.avx2; } },
+        { "sse2",   XorKernel_SSE2,   [](const CpuFeatures& f) { return f.sse2; } },
+#endif
+        { "scalar", XorKernel_Scalar, [](const CpuFeatures&) { return true; } },
+    };
+
+    const KernelEntry* PickKernel() {
+        const CpuFeatures& f = GetCpuFeatures();
+        for (const auto& k : kKernels)
+            if (k.supported(f)) return &k;
+        return &kKernels[sizeof(kKernels) / sizeof(kKernels[0]) - 1];
+    }
+
+    // Resolved on first use so callers running during static init (the
+    // ec2b pad derivation) are safe regardless of initialization order.
+    std::atomic<const KernelEntry*> g_kernel{ nullptr };
+
+    inline const KernelEntry* Kernel() {
+        const KernelEntry* k = g_kernel.load(std::memory_order_relaxed);
+        if (!k) {
+            k = PickKernel();
+            g_kernel.store(k, std::memory_order_relaxed);
+        }
+        return k;
+    }
+}
+
+static inline void XorRuns(uint8_t* dst, const uint8_t* src, size_t len,
+    const uint8_t* pad, size_t padLen, size_t padOffset) {
+    if (!dst || !pad || len == 0 || padLen == 0) return;
+    if (padOffset >= padLen) padOffset %= padLen;
+
+    const XorKernelFn fn = Kernel()->fn;
+    while (len) {
+        size_t run = padLen - padOffset;
+        if (run > len) run = len;
+        fn(dst, src, pad + padOffset, run);
+        dst += run; src += run; len -= run;
+        padOffset = 0;
+    }
+}
+
+void XorKeystream(uint8_t* data, size_t len,
+    const uint8_t* pad, size_t padLen, size_t padOffset) {
+    XorRuns(data, data, len, pad, padLen, padOffset);
+}
+
+void XorKeystreamCopy(uint8_t* dst, const uint8_t* src, size_t len,
+    const uint8_t* pad, size_t padLen, size_t padOffset) {
+    XorRuns(dst, src, len, pad, padLen, padOffset);
+}
+
+const char* XorKernelName() {
+    return Kernel()->name;
+}
+
+bool ForceXorKernel(const char* name) {
+    const CpuFeatures& f = GetCpuFeatures();
+    for (const auto& k : kKernels) {
+        if (std::strcmp(k.name, name) == 0) {
+            if (!k.supported(f)) return false;
+            g_kernel.store(&k, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
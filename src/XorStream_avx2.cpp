@@ -0,0 +1,33 @@
+#include "XorStream.h"
+#include <immintrin.h>
+
+void XorKernel_AVX2(uint8_t* dst, const uint8_t* src, const uint8_t* pad, size_t n) {
+    size_t i = 0;
+    for (; i + 128 <= n; i += 128) {
+        __m256i a0 = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i a1 = _mm256_loadu_si256((const __m256i*)(src + i + 32));
+        __m256i a2 = _mm256_loadu_si256((const __m256i*)(src + i + 64));
+        __m256i a3 = _mm256_loadu_si256((const __m256i*)(src + i + 96));
+        a0 = _mm256_xor_si256(a0, _mm256_loadu_si256((const __m256i*)(pad + i)));
+        a1 = _mm256_xor_si256(a1, _mm256_loadu_si256((const __m256i*)(pad + i + 32)));
+        a2 = _mm256_xor_si256(a2, _mm256_loadu_si256((const __m256i*)(pad + i + 64)));
+        a3 = _mm256_xor_si256(a3, _mm256_loadu_si256((const __m256i*)(pad + i + 96)));
+        _mm256_storeu_si256((__m256i*)(dst + i), a0);
+        _mm256_storeu_si256((__m256i*)(dst + i + 32), a1);
+        _mm256_storeu_si256((__m256i*)(dst + i + 64), a2);
+        _mm256_storeu_si256((__m256i*)(dst + i + 96), a3);
+    }
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+        a = _mm256_xor_si256(a, _mm256_loadu_si256((const __m256i*)(pad + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i), a);
+    }
+    if (i + 16 <= n) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+        a = _mm_xor_si128(a, _mm_loadu_si128((const __m128i*)(pad + i)));
+        _mm_storeu_si128((__m128i*)(dst + i), a);
+        i += 16;
+    }
+    _mm256_zeroupper();
+    if (i < n) XorKernel_Scalar(dst + i, src + i, pad + i, n - i);
+}
@@ -0,0 +1,33 @@
+#include "XorStream.h"
+#include <immintrin.h>
+
+void XorKernel_AVX512(uint8_t* dst, const uint8_t* src, const uint8_t* pad, size_t n) {
+    size_t i = 0;
+    for (; i + 256 <= n; i += 256) {
+        __m512i a0 = _mm512_loadu_si512((const void*)(src + i));
+        __m512i a1 = _mm512_loadu_si512((const void*)(src + i + 64));
+        __m512i a2 = _mm512_loadu_si512((const void*)(src + i + 128));
+        __m512i a3 = _mm512_loadu_si512((const void*)(src + i + 192));
+        a0 = _mm512_xor_si512(a0, _mm512_loadu_si512((const void*)(pad + i)));
+        a1 = _mm512_xor_si512(a1, _mm512_loadu_si512((const void*)(pad + i + 64)));
+        a2 = _mm512_xor_si512(a2, _mm512_loadu_si512((const void*)(pad + i + 128)));
+        a3 = _mm512_xor_si512(a3, _mm512_loadu_si512((const void*)(pad + i + 192)));
+        _mm512_storeu_si512((void*)(dst + i), a0);
+        _mm512_storeu_si512((void*)(dst + i + 64), a1);
+        _mm512_storeu_si512((void*)(dst + i + 128), a2);
+        _mm512_storeu_si512((void*)(dst + i + 192), a3);
+    }
+    for (; i + 64 <= n; i += 64) {
+        __m512i a = _mm512_loadu_si512((const void*)(src + i));
+        a = _mm512_xor_si512(a, _mm512_loadu_si512((const void*)(pad + i)));
+        _mm512_storeu_si512((void*)(dst + i), a);
+    }
+    if (i < n) {
+        // Masked tail: one partial vector instead of a scalar loop.
+        const __mmask64 m = (~0ULL) >> (64 - (n - i));
+        __m512i a = _mm512_maskz_loadu_epi8(m, src + i);
+        __m512i b = _mm512_maskz_loadu_epi8(m, pad + i);
+        _mm512_mask_storeu_epi8(dst + i, m, _mm512_xor_si512(a, b));
+    }
+    _mm256_zeroupper();
+}
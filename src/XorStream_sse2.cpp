@@ -0,0 +1,26 @@
+#include "XorStream.h"
+#include <emmintrin.h>
+
+void XorKernel_SSE2(uint8_t* dst, const uint8_t* src, const uint8_t* pad, size_t n) {
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i a1 = _mm_loadu_si128((const __m128i*)(src + i + 16));
+        __m128i a2 = _mm_loadu_si128((const __m128i*)(src + i + 32));
+        __m128i a3 = _mm_loadu_si128((const __m128i*)(src + i + 48));
+        a0 = _mm_xor_si128(a0, _mm_loadu_si128((const __m128i*)(pad + i)));
+        a1 = _mm_xor_si128(a1, _mm_loadu_si128((const __m128i*)(pad + i + 16)));
+        a2 = _mm_xor_si128(a2, _mm_loadu_si128((const __m128i*)(pad + i + 32)));
+        a3 = _mm_xor_si128(a3, _mm_loadu_si128((const __m128i*)(pad + i + 48)));
+        _mm_storeu_si128((__m128i*)(dst + i), a0);
+        _mm_storeu_si128((__m128i*)(dst + i + 16), a1);
+        _mm_storeu_si128((__m128i*)(dst + i + 32), a2);
+        _mm_storeu_si128((__m128i*)(dst + i + 48), a3);
+    }
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+        a = _mm_xor_si128(a, _mm_loadu_si128((const __m128i*)(pad + i)));
+        _mm_storeu_si128((__m128i*)(dst + i), a);
+    }
+    if (i < n) XorKernel_Scalar(dst + i, src + i, pad + i, n - i);
+}
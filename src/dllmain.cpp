@@ -3,7 +3,10 @@
 #include <cstdio>
 #include "Hooks.h"
 #include <iostream>
+#include <string>
 #include "ec2b_runtime.h"
+#include "Config.h"
+#include "Telemetry.h"
 
 static HINSTANCE g_hinst = NULL;
 static HANDLE g_workerThread = NULL;
@@ -54,6 +57,30 @@ static DWORD WINAPI WorkerThread(LPVOID) {
         Sleep(1);
     }
 
+    // Latency stats on demand: press Enter in the console. "reload" swaps
+    // in the edited cmd_filter rules.
+    if (g_hooksInitialized.load(std::memory_order_acquire)) {
+        printf("[EnetSniffer] Press Enter for per-stage latency stats, type reload to re-read cmd_filter.\n");
+        std::string line;
+        int c;
+        while ((c = getchar()) != EOF) {
+            if (c != '\n') {
+                if (c != '\r') line += char(c);
+                continue;
+            }
+            if (line == "reload") {
+                if (!PacketProcessor::ReloadFilter()) printf("[EnetSniffer] no cmd_filter to reload.\n");
+            }
+            else {
+                Telemetry::Report(stdout);
+                if (GetConfig().trackRtt) PacketProcessor::ReportRtt(stdout);
+                PacketProcessor::ReportSessions(stdout);
+                PacketProcessor::ReportMemory(stdout);
+            }
+            line.clear();
+        }
+    }
+
     HANDLE h = g_workerThread;
     g_workerThread = NULL;
     if (h) CloseHandle(h);
@@ -1,11 +1,13 @@
 #include "ec2b.h"
 #include "magic.h"
+#include "AesMhy.h"
+#include "Mt64.h"
 #include <cstdint>
 #include <cstring>
 #include <array>
 #include <string>
 #include <vector>
-#include <random>
+#include <stdexcept>
 
 #if defined(_MSC_VER)
 #include <intrin.h>
@@ -28,13 +30,6 @@ static inline uint64_t load64_le(const uint8_t* p) {
     return BSWAP64(v);
 #endif
 }
-static inline void store64_le(uint8_t* p, uint64_t v) {
-#if HOST_IS_LITTLE_ENDIAN
-    std::memcpy(p, &v, sizeof(v));
-#else
-    uint64_t w = BSWAP64(v); std::memcpy(p, &w, sizeof(w));
-#endif
-}
 
 static std::vector<uint8_t> base64_decode(const std::string& s) {
     static const int8_t T[256] = {
@@ -66,21 +61,28 @@ static std::vector<uint8_t> base64_decode(const std::string& s) {
     return out;
 }
 
-// ---- extern "C" AES quirk funcs come from aes.c ----
-extern void oqs_mhy128_enc_c(const uint8_t* plaintext, const void* _schedule, uint8_t* ciphertext);
-
 // ---- MHY helpers copied from earlier port ----
+
+// The scramble round keys depend only on aes_xorpad_table, so they are
+// folded once and reused for every blob.
+static const MhyAesKey& scramble_key() {
+    static const MhyAesKey k = [] {
+        uint8_t round_keys[11 * 16] = { 0 };
+        for (int round = 0; round <= 10; ++round)
+            for (int i = 0; i < 16; ++i)
+                for (int j = 0; j < 16; ++j) {
+                    const uint64_t idx = (uint64_t(round) << 8) + i * 16 + j;
+                    round_keys[round * 16 + i] ^= aes_xorpad_table[1][idx] ^ aes_xorpad_table[0][idx];
+                }
+        MhyAesKey key;
+        MhyAesPrepare(round_keys, key);
+        return key;
+    }();
+    return k;
+}
+
 static void key_scramble(uint8_t* key) {
-    uint8_t round_keys[11 * 16] = { 0 };
-    for (int round = 0; round <= 10; ++round)
-        for (int i = 0; i < 16; ++i)
-            for (int j = 0; j < 16; ++j) {
-                const uint64_t idx = (uint64_t(round) << 8) + i * 16 + j;
-                round_keys[round * 16 + i] ^= aes_xorpad_table[1][idx] ^ aes_xorpad_table[0][idx];
-            }
-    uint8_t chip[16];
-    oqs_mhy128_enc_c(key, round_keys, chip);
-    std::memcpy(key, chip, 16);
+    MhyAesEncrypt(scramble_key(), key, key, 1);
 }
 
 static void get_decrypt_vector(const uint8_t* key,
@@ -92,14 +94,12 @@ static void get_decrypt_vector(const uint8_t* key,
 
     const uint64_t k0 = load64_le(key + 0);
     const uint64_t k1 = load64_le(key + 8);
-    std::mt19937_64 mt(k1 ^ 0xCEAC3B5A867837ACull ^ val ^ k0);
-
-    const uint64_t n_out = output_size >> 3;
-    for (uint64_t i = 0; i < n_out; ++i) store64_le(output + i * 8, mt());
+    Mt64 mt(k1 ^ 0xCEAC3B5A867837ACull ^ val ^ k0);
+    mt.Fill(output, size_t(output_size & ~uint64_t(7)), Endian::Little);
 }
 
-static std::array<uint8_t, 4096> derive_xorpad_from_ec2b(const uint8_t* ec2b, std::size_t size) {
-    if (size != 2076) throw std::invalid_argument("ec2b size != 2076");
+std::array<uint8_t, 4096> derive_xorpad_from_ec2b(const uint8_t* ec2b, std::size_t size) {
+    if (size != kEc2bBlobSize) throw std::invalid_argument("ec2b size != 2076");
     uint8_t key[16];   std::memcpy(key, ec2b + 8, 16);
     uint8_t data[2048]; std::memcpy(data, ec2b + 28, 2048);
     key_scramble(key);
@@ -111,7 +111,10 @@ static std::array<uint8_t, 4096> derive_xorpad_from_ec2b(const uint8_t* ec2b, st
 
 // **** THIS is the symbol the linker is missing ****
 std::array<uint8_t, 4096> derive_xorpad_from_b64(const char* b64, std::size_t len) {
-    std::string input(b64, b64 + len);
-    auto decoded = base64_decode(input);
+    auto decoded = ec2b_decode_b64(b64, len);
     return derive_xorpad_from_ec2b(decoded.data(), decoded.size());
 }
+
+std::vector<uint8_t> ec2b_decode_b64(const char* b64, std::size_t len) {
+    return base64_decode(std::string(b64, b64 + len));
+}
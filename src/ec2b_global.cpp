@@ -1,8 +1,22 @@
 #include "ec2b_global.h"
+
+#if defined(SNIFFER_EC2B_PREBUILT)
+
+// ec2b_xorpad_table.cpp, generated into the build directory.
+extern const Ec2bXorpad kEc2bXorpadTable;
+
+const Ec2bXorpad& ec2b_xorpad() {
+    return kEc2bXorpadTable;
+}
+
+#else
+
 #include "ec2b.h"
 #include "ec2b_data.h"
 
-const std::vector<uint8_t> g_ec2b_xorpad = [] {
-    auto arr = derive_xorpad_from_b64(kEc2bB64, kEc2bB64Len);
-    return std::vector<uint8_t>(arr.begin(), arr.end());
-    }();
+const Ec2bXorpad& ec2b_xorpad() {
+    static const Ec2bXorpad pad = derive_xorpad_from_b64(kEc2bB64, kEc2bB64Len);
+    return pad;
+}
+
+#endif
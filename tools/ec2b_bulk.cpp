@@ -0,0 +1,119 @@
+// Bulk ec2b derivation into a content-addressed pad cache.
+//
+//   ec2b_bulk [--cache FILE] [--threads N] [--manifest FILE]... <blob|dir>...
+//
+// Inputs are raw 2076-byte ec2b blobs or their base64 text. A directory
+// contributes every regular file in it; a manifest lists one path per line
+// ('#' starts a comment). Pads already in the cache are not derived again.
+// Point ec2b_cache / ec2b_id in EnetSniffer.ini at the result.
+
+#include "Ec2bCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static int Usage() {
+    std::fprintf(stderr, "usage: ec2b_bulk [--cache FILE] [--threads N] [--manifest FILE]... <blob|dir>...\n");
+    return 2;
+}
+
+static void AddPath(const fs::path& p, std::vector<fs::path>& files) {
+    std::error_code ec;
+    if (fs::is_directory(p, ec)) {
+        std::vector<fs::path> found;
+        for (const auto& e : fs::directory_iterator(p, ec))
+            if (e.is_regular_file(ec)) found.push_back(e.path());
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    else {
+        files.push_back(p);
+    }
+}
+
+static bool AddManifest(const fs::path& manifest, std::vector<fs::path>& files) {
+    std::ifstream in(manifest);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t c = line.find('#');
+        if (c != std::string::npos) line.resize(c);
+        while (!line.empty() && (unsigned char)line.back() <= ' ') line.pop_back();
+        size_t b = 0;
+        while (b < line.size() && (unsigned char)line[b] <= ' ') ++b;
+        if (b == line.size()) continue;
+        fs::path p = line.substr(b);
+        if (p.is_relative()) p = manifest.parent_path() / p;
+        AddPath(p, files);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    fs::path cachePath = "ec2b_cache.bin";
+    unsigned threads = 0;
+    std::vector<fs::path> files;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--cache") && i + 1 < argc) cachePath = argv[++i];
+        else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc) threads = unsigned(std::atoi(argv[++i]));
+        else if (!std::strcmp(argv[i], "--manifest") && i + 1 < argc) {
+            if (!AddManifest(argv[++i], files)) {
+                std::fprintf(stderr, "cannot read manifest %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (argv[i][0] == '-') return Usage();
+        else AddPath(argv[i], files);
+    }
+    if (files.empty()) return Usage();
+
+    Ec2bPadCache cache;
+    if (!cache.Load(cachePath)) {
+        std::fprintf(stderr, "%s is not an ec2b cache\n", cachePath.string().c_str());
+        return 1;
+    }
+
+    std::vector<Ec2bJob> jobs;
+    size_t rejected = 0;
+    for (const fs::path& f : files) {
+        std::ifstream in(f, std::ios::binary);
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        Ec2bJob job;
+        job.name = f.string();
+        if (!in.good() && !in.eof()) data.clear();
+        if (!ParseEc2bBlob(data.data(), data.size(), job.blob)) {
+            std::printf("%-16s  %s  (not an ec2b blob)\n", "-", job.name.c_str());
+            ++rejected;
+            continue;
+        }
+        jobs.push_back(std::move(job));
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const size_t derived = DeriveEc2bPads(jobs, cache, threads);
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (const Ec2bJob& j : jobs) {
+        std::printf("%016llx  %s%s\n", (unsigned long long)j.hash, j.name.c_str(),
+            j.cached ? "  (cached)" : j.ok ? "" : "  (derivation failed)");
+    }
+
+    if (derived && !cache.Save(cachePath)) {
+        std::fprintf(stderr, "cannot write %s\n", cachePath.string().c_str());
+        return 1;
+    }
+    std::printf("%zu blobs, %zu derived in %.3f s, %zu rejected, %zu pads in %s\n",
+        jobs.size(), derived, secs, rejected, cache.Size(), cachePath.string().c_str());
+    return 0;
+}
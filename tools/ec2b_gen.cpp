@@ -0,0 +1,41 @@
+// Build step: derives the xorpad of the built-in ec2b blob and writes it as
+// a constant table, so the DLL does no ec2b work at load time.
+//
+//   ec2b_gen <out.cpp>
+
+#include "ec2b.h"
+#include "ec2b_data.h"
+
+#include <cstdio>
+#include <exception>
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: ec2b_gen <out.cpp>\n");
+        return 2;
+    }
+
+    std::array<uint8_t, 4096> pad;
+    try {
+        pad = derive_xorpad_from_b64(kEc2bB64, kEc2bB64Len);
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "ec2b_gen: %s\n", e.what());
+        return 1;
+    }
+
+    FILE* out = std::fopen(argv[1], "w");
+    if (!out) {
+        std::fprintf(stderr, "ec2b_gen: cannot write %s\n", argv[1]);
+        return 1;
+    }
+    std::fprintf(out, "// Generated by ec2b_gen from src/ec2b_data.cpp. Do not edit.\n");
+    std::fprintf(out, "#include \"ec2b_global.h\"\n\n");
+    std::fprintf(out, "extern const Ec2bXorpad kEc2bXorpadTable;\n");
+    std::fprintf(out, "const Ec2bXorpad kEc2bXorpadTable = {{\n");
+    for (size_t i = 0; i < pad.size(); ++i) {
+        std::fprintf(out, "%s0x%02X,%s", i % 16 ? " " : "    ", pad[i], i % 16 == 15 ? "\n" : "");
+    }
+    std::fprintf(out, "}};\n");
+    return std::fclose(out) == 0 ? 0 : 1;
+}
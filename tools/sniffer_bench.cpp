@@ -0,0 +1,714 @@
+// Microbenchmarks for the decode hot path, emitted as JSON.
+//
+//   sniffer_bench [--filter SUBSTR] [--min-ms N] [--out FILE]
+//
+// Every case reports ns/op, bytes/s (where an op has a byte size) and heap
+// allocations per op, counted by the operator new overrides below. A table
+// goes to stdout and the JSON to --out (default sniffer_bench.json). The
+// process/* cases run the full live path including the writer thread, so
+// they leave a capture in the configured output dir next to the binary.
+
+#include "AesMhy.h"
+#include "CaptureFormat.h"
+#include "CmdFilter.h"
+#include "Compression.h"
+#include "Config.h"
+#include "Correlator.h"
+#include "Framing.h"
+#include "HexDump.h"
+#include "KeyCache.h"
+#include "Lz4.h"
+#include "MpscRing.h"
+#include "Mt64.h"
+#include "PacketBuffer.h"
+#include "PacketDecoder.h"
+#include "PacketProcessor.h"
+#include "ProtoScan.h"
+#include "ProtoWire.h"
+#include "SessionKey.h"
+#include "XorStream.h"
+#include "ec2b.h"
+#include "ec2b_data.h"
+#include "ec2b_global.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---- allocation counting ----------------------------------------------------
+
+static std::atomic<uint64_t> g_allocs{ 0 };
+
+void* operator new(std::size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return ::operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+static void* AlignedAlloc(std::size_t n, std::size_t align) {
+#if defined(_MSC_VER)
+    return _aligned_malloc(n ? n : 1, align);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, align < sizeof(void*) ? sizeof(void*) : align, n ? n : 1) == 0 ? p : nullptr;
+#endif
+}
+static void AlignedFree(void* p) {
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+void* operator new(std::size_t n, std::align_val_t a) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = AlignedAlloc(n, std::size_t(a))) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n, std::align_val_t a) { return ::operator new(n, a); }
+void operator delete(void* p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { AlignedFree(p); }
+
+// ---- harness -----------------------------------------------------------------
+
+static volatile uint64_t g_sink;
+static inline void Consume(uint64_t v) { g_sink = g_sink ^ v; }
+
+struct Result {
+    std::string name;
+    uint64_t ops = 0;
+    double nsPerOp = 0;
+    double bytesPerSec = 0;
+    double allocsPerOp = 0;
+};
+
+struct Options {
+    std::string filter;
+    double minMs = 200;
+};
+
+static Options g_opt;
+static std::vector<Result> g_results;
+
+static bool Wanted(const std::string& name) {
+    return g_opt.filter.empty() || name.find(g_opt.filter) != std::string::npos;
+}
+
+// Runs `op` in growing batches until a batch takes at least --min-ms, then
+// reports that batch. `maxOps` bounds cases with side effects on disk.
+static void Bench(const std::string& name, size_t bytesPerOp, const std::function<void()>& op,
+    uint64_t maxOps = UINT64_MAX) {
+    if (!Wanted(name)) return;
+    using Clock = std::chrono::steady_clock;
+
+    op();  // warm caches and lazy init outside the measurement
+
+    uint64_t n = 1;
+    for (;;) {
+        const uint64_t allocs0 = g_allocs.load(std::memory_order_relaxed);
+        const auto t0 = Clock::now();
+        for (uint64_t i = 0; i < n; ++i) op();
+        const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+        const uint64_t allocs = g_allocs.load(std::memory_order_relaxed) - allocs0;
+
+        if (ns >= g_opt.minMs * 1e6 || n >= maxOps) {
+            Result r;
+            r.name = name;
+            r.ops = n;
+            r.nsPerOp = ns / double(n);
+            r.bytesPerSec = bytesPerOp ? double(bytesPerOp) * double(n) / (ns / 1e9) : 0;
+            r.allocsPerOp = double(allocs) / double(n);
+            g_results.push_back(r);
+            std::printf("%-36s %12.1f ns/op %10.1f MB/s %6.2f allocs/op\n",
+                name.c_str(), r.nsPerOp, r.bytesPerSec / 1e6, r.allocsPerOp);
+            return;
+        }
+        n = n * 2 > maxOps ? maxOps : n * 2;
+    }
+}
+
+// ---- synthetic frames ------------------------------------------------------------
+
+static void PutBE16(std::vector<uint8_t>& v, uint16_t x) { v.push_back(uint8_t(x >> 8)); v.push_back(uint8_t(x)); }
+static void PutBE32(std::vector<uint8_t>& v, uint32_t x) { PutBE16(v, uint16_t(x >> 16)); PutBE16(v, uint16_t(x)); }
+static void PutVarint(std::vector<uint8_t>& v, uint64_t x) {
+    while (x >= 0x80) { v.push_back(uint8_t(x | 0x80)); x >>= 7; }
+    v.push_back(uint8_t(x));
+}
+
+// A realistic PacketHead: sent_ms (field 2), client_sequence_id (4) and a
+// couple of small ids, the way the game fills it in.
+static std::vector<uint8_t> MakeHead(uint32_t seq) {
+    std::vector<uint8_t> h;
+    PutVarint(h, (1 << 3) | 0); PutVarint(h, 1);
+    PutVarint(h, (2 << 3) | 0); PutVarint(h, 1700000000000ull + seq);
+    PutVarint(h, (4 << 3) | 0); PutVarint(h, seq);
+    PutVarint(h, (11 << 3) | 0); PutVarint(h, 3);
+    return h;
+}
+
+// Frame of `total` bytes with the given cmd id, encrypted with `pad`.
+static std::vector<uint8_t> MakeFrame(uint16_t cmd, size_t total, const std::vector<uint8_t>& payloadHint,
+    const uint8_t* pad, size_t padLen, uint32_t seq = 1) {
+    const std::vector<uint8_t> head = MakeHead(seq);
+    const size_t fixed = kFrameHeaderSize + head.size() + kFrameTrailerSize;
+    std::vector<uint8_t> payload = payloadHint;
+    uint32_t x = 0x9E3779B9u ^ seq;
+    while (fixed + payload.size() < total) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        payload.push_back(uint8_t(x));
+    }
+
+    std::vector<uint8_t> f;
+    PutBE16(f, kFrameMagic);
+    PutBE16(f, cmd);
+    PutBE16(f, uint16_t(head.size()));
+    PutBE32(f, uint32_t(payload.size()));
+    f.insert(f.end(), head.begin(), head.end());
+    f.insert(f.end(), payload.begin(), payload.end());
+    PutBE16(f, kFrameTrailer);
+    if (pad) XorKeystream(f.data(), f.size(), pad, padLen);
+    return f;
+}
+
+static constexpr uint64_t kSeed = 0x1234567890ull;
+
+// GetPlayerTokenRsp-shaped payload: a few fields ahead of the seed.
+// `tokenLen` sizes the account token string.
+static std::vector<uint8_t> MakeTokenRspPayload(size_t tokenLen = 24) {
+    std::vector<uint8_t> p;
+    PutVarint(p, (1 << 3) | 0); PutVarint(p, 0);
+    PutVarint(p, (2 << 3) | 2); PutVarint(p, tokenLen);
+    for (size_t i = 0; i < tokenLen; ++i) p.push_back(uint8_t('a' + i % 24));
+    PutVarint(p, (3 << 3) | 0); PutVarint(p, 100000123);
+    PutVarint(p, (5 << 3) | 1);
+    for (int i = 0; i < 8; ++i) p.push_back(uint8_t(i));
+    PutVarint(p, (11 << 3) | 0); PutVarint(p, kSeed);
+    return p;
+}
+
+static const size_t kFrameSizes[] = { 64, 512, 1400, 4096, 32768 };
+
+// ---- cases -------------------------------------------------------------------------
+
+static void BenchXor() {
+    const std::vector<uint8_t> key = NewKeyFromSeed(kSeed);
+    const char* kernels[] = { "scalar", "sse2", "avx2", "avx512" };
+    const std::string active = XorKernelName();
+    for (const char* k : kernels) {
+        if (!ForceXorKernel(k)) continue;
+        for (size_t n : { size_t(64), size_t(1400), size_t(16384), size_t(262144) }) {
+            std::vector<uint8_t> buf(n, 0x5A);
+            Bench("xor/" + std::string(k) + "/" + std::to_string(n), n, [&] {
+                XorKeystream(buf.data(), buf.size(), key.data(), key.size(), 7);
+                Consume(buf[0]);
+            });
+        }
+    }
+    ForceXorKernel(active.c_str());
+}
+
+// Every MHY AES backend must match the reference bit for bit; a bench run
+// doubles as the cross-check.
+static bool CheckMhyAes() {
+    uint32_t x = 0x12345678u;
+    auto next = [&] { x ^= x << 13; x ^= x >> 17; x ^= x << 5; return uint8_t(x); };
+
+    const std::string active = MhyAesBackendName();
+    bool ok = true;
+    for (const char* b : { "ttable", "aesni" }) {
+        if (!ForceMhyAesBackend(b)) continue;
+        for (int trial = 0; trial < 64 && ok; ++trial) {
+            uint8_t rk[176], in[16 * 7], enc[16 * 7], dec[16 * 7];
+            for (auto& v : rk) v = next();
+            for (auto& v : in) v = next();
+            MhyAesKey key;
+            MhyAesPrepare(rk, key);
+            MhyAesEncrypt(key, in, enc, 7);
+            MhyAesDecrypt(key, in, dec, 7);
+            for (int blk = 0; blk < 7; ++blk) {
+                uint8_t refEnc[16], refDec[16];
+                oqs_mhy128_enc_c(in + 16 * blk, rk, refEnc);
+                oqs_mhy128_dec_c(in + 16 * blk, rk, refDec);
+                if (std::memcmp(refEnc, enc + 16 * blk, 16) || std::memcmp(refDec, dec + 16 * blk, 16)) {
+                    std::fprintf(stderr, "mhy aes backend %s disagrees with the reference\n", b);
+                    ok = false;
+                    break;
+                }
+            }
+        }
+    }
+    ForceMhyAesBackend(active.c_str());
+    return ok;
+}
+
+static void BenchAes() {
+    uint8_t rk[176];
+    for (int i = 0; i < 176; ++i) rk[i] = uint8_t(i * 13 + 7);
+    MhyAesKey key;
+    MhyAesPrepare(rk, key);
+
+    uint8_t block[16] = {};
+    Bench("aes/mhy_enc/reference", 16, [&] { oqs_mhy128_enc_c(block, rk, block); Consume(block[0]); });
+    Bench("aes/mhy_dec/reference", 16, [&] { oqs_mhy128_dec_c(block, rk, block); Consume(block[0]); });
+
+    const std::string active = MhyAesBackendName();
+    std::vector<uint8_t> buf(4096);
+    for (const char* b : { "ttable", "aesni" }) {
+        if (!ForceMhyAesBackend(b)) continue;
+        Bench("aes/mhy_enc/" + std::string(b), 16, [&] { MhyAesEncrypt(key, block, block, 1); Consume(block[0]); });
+        Bench("aes/mhy_enc_4096/" + std::string(b), buf.size(), [&] {
+            MhyAesEncrypt(key, buf.data(), buf.data(), buf.size() / 16);
+            Consume(buf[0]);
+        });
+        Bench("aes/mhy_dec_4096/" + std::string(b), buf.size(), [&] {
+            MhyAesDecrypt(key, buf.data(), buf.data(), buf.size() / 16);
+            Consume(buf[0]);
+        });
+    }
+    ForceMhyAesBackend(active.c_str());
+}
+
+static void BenchKeys() {
+    Mt64 mt(kSeed);
+    Bench("mt64/next", 8, [&] { Consume(mt.Next()); });
+    const std::string active = Mt64KernelName();
+    for (const char* k : { "scalar", "avx2" }) {
+        if (!ForceMt64Kernel(k)) continue;
+        std::vector<uint8_t> out(4096);
+        Bench("mt64/fill_be_4096/" + std::string(k), out.size(), [&] {
+            mt.Fill(out.data(), out.size(), Endian::Big);
+            Consume(out[0]);
+        });
+    }
+    ForceMt64Kernel(active.c_str());
+    Bench("key/new_from_seed", 4096, [] { Consume(NewKeyFromSeed(kSeed)[4095]); });
+    std::vector<uint8_t> keyBuf(kSessionKeySize);
+    Bench("key/derive_into", kSessionKeySize, [&] { DeriveKeyInto(kSeed, keyBuf.data()); Consume(keyBuf[0]); });
+    KeyCache cache(16);
+    Bench("key/cache_hit", 0, [&] { Consume(cache.Get(kSeed)->bytes[0]); });
+
+    const std::vector<uint8_t> rsp = MakeTokenRspPayload();
+    Bench("key/extract_seed", rsp.size(), [&] {
+        uint64_t seed = 0;
+        ExtractSecretKeySeed(rsp.data(), rsp.size(), seed);
+        Consume(seed);
+    });
+
+    Bench("ec2b/derive_xorpad", kEc2bB64Len, [] {
+        Consume(derive_xorpad_from_b64(kEc2bB64, kEc2bB64Len)[0]);
+    });
+}
+
+static bool CheckVarints() {
+    // Widths 1..10 with runs of single bytes, so every kernel path is hit.
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    std::vector<uint8_t> buf;
+    for (int i = 0; i < 20000; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        const unsigned w = (x >> 60) < 8 ? 0 : unsigned(x % 10);
+        PutVarint(buf, w == 0 ? (x >> 57) : x >> (64 - 7 * w));
+    }
+    buf.push_back(0x80);  // truncated tail
+
+    std::vector<uint64_t> ref(buf.size()), got(buf.size());
+    const uint8_t* rp = buf.data();
+    const size_t refN = ReadVarints_Scalar(rp, buf.data() + buf.size(), ref.data(), ref.size());
+
+    const std::string active = VarintKernelName();
+    bool ok = true;
+    for (const char* k : { "ssse3", "avx2" }) {
+        if (!ForceVarintKernel(k)) continue;
+        for (size_t max : { size_t(1), size_t(7), size_t(33), buf.size() }) {
+            const uint8_t* p = buf.data();
+            const size_t n = ReadVarints(p, buf.data() + buf.size(), got.data(), max);
+            const size_t want = max < refN ? max : refN;
+            if (n != want || std::memcmp(got.data(), ref.data(), n * 8) || (max >= refN && p != rp)) {
+                std::fprintf(stderr, "varint kernel %s disagrees with the scalar decoder\n", k);
+                ok = false;
+                break;
+            }
+        }
+    }
+    ForceVarintKernel(active.c_str());
+    return ok;
+}
+
+static void BenchProto() {
+    // Mix of 1..10-byte varints, as seen in packed fields and tags.
+    std::vector<uint8_t> buf;
+    uint64_t x = 88172645463325252ull;
+    for (int i = 0; i < 1024; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        PutVarint(buf, x >> ((i % 10) * 7));
+    }
+    Bench("proto/read_varint_x1024", buf.size(), [&] {
+        const uint8_t* p = buf.data();
+        const uint8_t* end = p + buf.size();
+        uint64_t v, sum = 0;
+        while (ReadVarint(p, end, v)) sum += v;
+        Consume(sum);
+    });
+
+    // Bulk kernels on 64K varints (too many for the branch predictor to
+    // learn): random widths 1..10, and a SceneEntityMoveNotify-like packed
+    // field of mostly 1-2 byte values.
+    std::vector<uint8_t> mixed, small;
+    for (int i = 0; i < 65536; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        PutVarint(mixed, x >> (7 * (x % 10)));
+        PutVarint(small, (x & 7) == 0 ? (x >> 50) : (x >> 57));
+    }
+    std::vector<uint64_t> vals(65536);
+    const std::string active = VarintKernelName();
+    for (const char* k : { "scalar", "ssse3", "avx2" }) {
+        if (!ForceVarintKernel(k)) continue;
+        Bench("proto/read_varints_x65536/" + std::string(k), mixed.size(), [&] {
+            const uint8_t* p = mixed.data();
+            Consume(ReadVarints(p, p + mixed.size(), vals.data(), vals.size()) + vals[65535]);
+        });
+        Bench("proto/read_varints_small_x65536/" + std::string(k), small.size(), [&] {
+            const uint8_t* p = small.data();
+            Consume(ReadVarints(p, p + small.size(), vals.data(), vals.size()) + vals[65535]);
+        });
+    }
+    ForceVarintKernel(active.c_str());
+
+    // Message shaped like a typical notify: repeated entries, each a nested
+    // message with a few varints and a short string.
+    for (size_t n : { size_t(512), size_t(4096), size_t(32768) }) {
+        std::vector<uint8_t> entry;
+        PutVarint(entry, (1 << 3) | 0); PutVarint(entry, 10000042);
+        PutVarint(entry, (2 << 3) | 0); PutVarint(entry, 3);
+        PutVarint(entry, (3 << 3) | 2); PutVarint(entry, 12);
+        for (int i = 0; i < 12; ++i) entry.push_back(uint8_t('a' + i));
+        PutVarint(entry, (4 << 3) | 5);
+        for (int i = 0; i < 4; ++i) entry.push_back(uint8_t(i));
+        std::vector<uint8_t> msg;
+        while (msg.size() < n) {
+            PutVarint(msg, (1 << 3) | 2); PutVarint(msg, entry.size());
+            msg.insert(msg.end(), entry.begin(), entry.end());
+        }
+        std::vector<ProtoField> fields;
+        Bench("proto/scan/" + std::to_string(n), msg.size(), [&] {
+            ScanProto(msg.data(), msg.size(), fields);
+            Consume(fields.size());
+        });
+    }
+
+    for (size_t n : { size_t(256), size_t(4096) }) {
+        std::vector<uint8_t> data(n);
+        for (size_t i = 0; i < n; ++i) data[i] = uint8_t(i * 31);
+        Bench("hexdump/to_hex/" + std::to_string(n), n, [&] { Consume(to_hex(data.data(), n, true).size()); });
+    }
+
+    // PacketHead decode plus request/response pairing, as the writer runs it.
+    std::vector<uint8_t> head;
+    PutVarint(head, (1 << 3) | 0); PutVarint(head, 5);
+    PutVarint(head, (3 << 3) | 0); PutVarint(head, 123456);
+    PutVarint(head, (6 << 3) | 0); PutVarint(head, 1700000000000ull);
+    Correlator corr;
+    RecordHeader req, rsp;
+    req.cmdId = 5; req.direction = 0; req.headLen = uint32_t(head.size());
+    rsp.cmdId = 6; rsp.direction = 1; rsp.headLen = uint32_t(head.size());
+    uint64_t ts = 0;
+    Bench("rtt/observe_pair", 2 * head.size(), [&] {
+        req.timestampNs = ts += 1000;
+        rsp.timestampNs = ts += 1000;
+        corr.Observe(req, head.data());
+        corr.Observe(rsp, head.data());
+    });
+}
+
+// Notify-like payload of about `n` bytes: entries with ids, counters and
+// short names that vary with `seed`, so repeats are structural only.
+static std::vector<uint8_t> MakeNotifyPayload(size_t n, uint64_t seed) {
+    std::vector<uint8_t> msg, entry;
+    uint64_t x = seed | 1;
+    while (msg.size() < n) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        entry.clear();
+        PutVarint(entry, (1 << 3) | 0); PutVarint(entry, 10000000 + x % 100000);
+        PutVarint(entry, (2 << 3) | 0); PutVarint(entry, x >> 59);
+        PutVarint(entry, (3 << 3) | 2); PutVarint(entry, 8);
+        for (int i = 0; i < 8; ++i) entry.push_back(uint8_t('a' + (x >> (4 * i)) % 6));
+        PutVarint(entry, (4 << 3) | 5);
+        for (int i = 0; i < 4; ++i) entry.push_back(uint8_t(x >> (8 * i + 20)));
+        PutVarint(msg, (1 << 3) | 2); PutVarint(msg, entry.size());
+        msg.insert(msg.end(), entry.begin(), entry.end());
+    }
+    return msg;
+}
+
+static bool CheckLz4() {
+    std::vector<uint8_t> dictSrc;
+    for (uint64_t s = 1; s <= 8; ++s) {
+        const auto m = MakeNotifyPayload(512, s * 977);
+        dictSrc.insert(dictSrc.end(), m.begin(), m.end());
+    }
+    Lz4Dict dict;
+    Lz4PrepareDict(dictSrc.data(), dictSrc.size(), dict);
+    for (size_t n : { size_t(0), size_t(5), size_t(13), size_t(300), size_t(4096), size_t(70000) }) {
+        const auto src = MakeNotifyPayload(n, n + 7);
+        std::vector<uint8_t> packed(Lz4CompressBound(src.size())), back(src.size());
+        for (const Lz4Dict* d : { static_cast<const Lz4Dict*>(nullptr), static_cast<const Lz4Dict*>(&dict) }) {
+            const size_t c = Lz4Compress(src.data(), src.size(), packed.data(), packed.size(), d);
+            if (!c || !Lz4Decompress(packed.data(), c, back.data(), back.size(),
+                d ? d->bytes.data() : nullptr, d ? d->bytes.size() : 0) || back != src) {
+                std::fprintf(stderr, "lz4 round trip failed for %zu bytes\n", src.size());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// The live path with compression on: the token response must be committed
+// from its plain payload, or every keyed frame after it is a bad frame.
+static bool CheckProcessCompressed() {
+    const std::vector<uint8_t> key = NewKeyFromSeed(kSeed);
+    const Ec2bXorpad& ec2b = ec2b_xorpad();
+    static const char peers[2] = {};  // own sessions, apart from BenchProcess
+    bool ok = true;
+    for (Codec c : { Codec::Lz4, Codec::Zstd }) {
+        if (!PacketProcessor::_InternalSetCompression(c)) continue;
+        const void* peer = &peers[c == Codec::Zstd];
+        const uint64_t before = PacketProcessor::FrameErrors();
+        // Real-sized: well over compress_min_bytes, so it would be packed.
+        const auto req = MakeFrame(GET_PLAYER_TOKEN_REQ, 64, {}, ec2b.data(), ec2b.size());
+        const auto rsp = MakeFrame(GET_PLAYER_TOKEN_RSP, 0, MakeTokenRspPayload(600), ec2b.data(), ec2b.size());
+        PacketProcessor::Process(peer, req.data(), req.size(), PacketSource::Client);
+        PacketProcessor::Process(peer, rsp.data(), rsp.size(), PacketSource::Server);
+        for (uint32_t seq = 2; seq <= 6; ++seq) {
+            const auto f = MakeFrame(3001, 512, {}, key.data(), key.size(), seq);
+            PacketProcessor::Process(peer, f.data(), f.size(), PacketSource::Server);
+        }
+        PacketProcessor::_InternalDrain();
+        const uint64_t errors = PacketProcessor::FrameErrors() - before;
+        if (errors) {
+            std::fprintf(stderr, "process with %s compression: %llu bad frames\n",
+                CodecName(c), (unsigned long long)errors);
+            ok = false;
+        }
+    }
+    PacketProcessor::_InternalSetCompression(GetConfig().compression);
+    return ok;
+}
+
+static void BenchCompress() {
+    std::vector<uint8_t> dictSrc;
+    for (uint64_t s = 1; s <= 16; ++s) {
+        const auto m = MakeNotifyPayload(512, s * 977);
+        dictSrc.insert(dictSrc.end(), m.begin(), m.end());
+    }
+    Lz4Dict dict;
+    Lz4PrepareDict(dictSrc.data(), dictSrc.size(), dict);
+
+    for (size_t n : { size_t(256), size_t(1400), size_t(32768) }) {
+        const auto src = MakeNotifyPayload(n, 424242);
+        std::vector<uint8_t> packed(Lz4CompressBound(src.size())), back(src.size());
+        for (const Lz4Dict* d : { static_cast<const Lz4Dict*>(nullptr), static_cast<const Lz4Dict*>(&dict) }) {
+            const std::string suffix = std::to_string(n) + (d ? "/dict" : "");
+            size_t c = 0;
+            Bench("compress/lz4/" + suffix, src.size(), [&] {
+                c = Lz4Compress(src.data(), src.size(), packed.data(), packed.size(), d);
+                Consume(c);
+            });
+            if (!c) c = Lz4Compress(src.data(), src.size(), packed.data(), packed.size(), d);
+            Bench("decompress/lz4/" + suffix, src.size(), [&] {
+                Consume(Lz4Decompress(packed.data(), c, back.data(), back.size(),
+                    d ? d->bytes.data() : nullptr, d ? d->bytes.size() : 0));
+            });
+        }
+    }
+
+    if (CodecAvailable(Codec::Zstd)) {
+        // Whole records, as the workers compress them.
+        const auto payload = MakeNotifyPayload(1400, 424242);
+        RecordHeader rec;
+        rec.cmdId = 3001;
+        rec.payloadLen = uint32_t(payload.size());
+        std::vector<uint8_t> record(rec.RecordSize());
+        EncodeRecordHeader(record.data(), rec);
+        std::memcpy(record.data() + kRecordHeaderSize, payload.data(), payload.size());
+        CompressionOptions opt;
+        opt.codec = Codec::Zstd;
+        PacketBuffer packed;
+        Bench("compress/zstd/1400", payload.size(), [&] {
+            Consume(CompressRecord(record.data(), opt, packed));
+            packed.Release();
+        });
+    }
+}
+
+static void BenchDecode() {
+    const std::vector<uint8_t> key = NewKeyFromSeed(kSeed);
+    const Ec2bXorpad& ec2b = ec2b_xorpad();
+
+    for (size_t n : kFrameSizes) {
+        PacketDecoder dec;
+        RecordHeader rec;
+        PacketBuffer out;
+        // Install the session key through the real handshake path.
+        const auto rsp = MakeFrame(GET_PLAYER_TOKEN_RSP, 0, MakeTokenRspPayload(), ec2b.data(), ec2b.size());
+        rec.index = 2;
+        dec.Decode(rsp.data(), rsp.size(), rec.index, rec, out);
+
+        const auto f = MakeFrame(3001, n, {}, key.data(), key.size());
+        Bench("decode/" + std::to_string(n), f.size(), [&] {
+            rec.index = 3;
+            dec.Decode(f.data(), f.size(), rec.index, rec, out);
+            Consume(out.data()[kRecordHeaderSize]);
+            out.Release();
+        });
+    }
+}
+
+static void BenchFilter() {
+    // The per-packet check the sequencer runs after the header decrypt.
+    CmdFilter filter;
+    filter.ParseLine("deny SC:PingRsp, 4");
+    filter.ParseLine("sample 3001 every 50");
+    filter.ParseLine("sample 3002 rate 1000/100");
+    filter.ParseLine("sample 3003 first 10");
+    SessionSamples samples;
+    uint64_t ts = 0;
+    uint16_t cmd = 2999;
+    Bench("filter/pass_sample", 0, [&] {
+        cmd = cmd == 3004 ? 2999 : uint16_t(cmd + 1);
+        ts += 100000;
+        Consume(filter.Pass(cmd, PacketSource::Server) && filter.Sample(cmd, PacketSource::Server, ts, samples));
+    });
+}
+
+static void BenchQueue() {
+    struct Job { RecordHeader hdr; PacketBuffer record; };
+    MpscRing<Job> ring(1 << 15);
+
+    Bench("queue/push_pop", 0, [&] {
+        Job in, out;
+        in.record = PacketBuffer::Acquire(512);
+        ring.TryPush(in);
+        ring.TryPop(out);
+        Consume(out.record.size());
+    });
+
+    // Contended: producers push pooled jobs, this thread drains. One op is
+    // one record through the ring.
+    const unsigned producers = std::thread::hardware_concurrency() > 4 ? 4 : 2;
+    Bench("queue/mpsc_" + std::to_string(producers) + "p", 0, [&] {
+        constexpr int kPerProducer = 4096;
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < producers; ++t) {
+            threads.emplace_back([&] {
+                for (int i = 0; i < kPerProducer; ++i) {
+                    Job j;
+                    j.record = PacketBuffer::Acquire(512);
+                    while (!ring.TryPush(j)) std::this_thread::yield();
+                }
+            });
+        }
+        Job out;
+        for (unsigned got = 0; got < producers * kPerProducer;) {
+            if (ring.TryPop(out)) { out.record.Release(); ++got; }
+        }
+        for (auto& t : threads) t.join();
+    });
+}
+
+static void BenchProcess() {
+    bool any = false;
+    for (size_t n : kFrameSizes) any |= Wanted("process/" + std::to_string(n));
+    if (!any) return;
+
+    const std::vector<uint8_t> key = NewKeyFromSeed(kSeed);
+    const Ec2bXorpad& ec2b = ec2b_xorpad();
+
+    // Handshake first so the following frames take the keyed path (indices
+    // 1 and 2 are the ec2b-wrapped token exchange).
+    const auto req = MakeFrame(GET_PLAYER_TOKEN_REQ, 64, {}, ec2b.data(), ec2b.size());
+    const auto rsp = MakeFrame(GET_PLAYER_TOKEN_RSP, 0, MakeTokenRspPayload(), ec2b.data(), ec2b.size());
+    PacketProcessor::Process(req.data(), req.size(), PacketSource::Client);
+    PacketProcessor::Process(rsp.data(), rsp.size(), PacketSource::Server);
+
+    for (size_t n : kFrameSizes) {
+        const auto f = MakeFrame(3001, n, {}, key.data(), key.size());
+        // Bound what ends up on disk to ~64 MB per case.
+        const uint64_t maxOps = (64ull << 20) / f.size();
+        Bench("process/" + std::to_string(n), f.size(), [&] {
+            PacketProcessor::Process(f.data(), f.size(), PacketSource::Server);
+        }, maxOps);
+    }
+}
+
+// ---- output --------------------------------------------------------------------------
+
+static void WriteJson(FILE* out) {
+    std::fprintf(out, "{\n  \"context\": {\"xor_kernel\": \"%s\", \"min_ms\": %.0f},\n  \"benchmarks\": [\n",
+        XorKernelName(), g_opt.minMs);
+    for (size_t i = 0; i < g_results.size(); ++i) {
+        const Result& r = g_results[i];
+        std::fprintf(out, "    {\"name\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.2f, "
+            "\"bytes_per_sec\": %.0f, \"allocs_per_op\": %.3f}%s\n",
+            r.name.c_str(), (unsigned long long)r.ops, r.nsPerOp, r.bytesPerSec, r.allocsPerOp,
+            i + 1 < g_results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+static int Usage() {
+    std::fprintf(stderr, "usage: sniffer_bench [--filter SUBSTR] [--min-ms N] [--out FILE]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    const char* outPath = "sniffer_bench.json";
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--filter") && i + 1 < argc) g_opt.filter = argv[++i];
+        else if (!std::strcmp(argv[i], "--min-ms") && i + 1 < argc) g_opt.minMs = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--out") && i + 1 < argc) outPath = argv[++i];
+        else return Usage();
+    }
+
+    // The pipeline, once started by a check or a case, is stopped on the way out.
+    if (!CheckMhyAes() || !CheckVarints() || !CheckLz4() || !CheckProcessCompressed()) {
+        PacketProcessor::_InternalShutdown();
+        return 1;
+    }
+
+    BenchXor();
+    BenchAes();
+    BenchKeys();
+    BenchProto();
+    BenchCompress();
+    BenchDecode();
+    BenchFilter();
+    BenchQueue();
+    BenchProcess();
+    PacketProcessor::_InternalShutdown();
+
+    FILE* out = std::fopen(outPath, "w");
+    if (!out) {
+        std::fprintf(stderr, "cannot open %s\n", outPath);
+        return 1;
+    }
+    WriteJson(out);
+    std::fclose(out);
+    std::printf("wrote %s\n", outPath);
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Offline replay of capture segments through the live decode pipeline.
+//
+//   sniffer_replay [--out DIR] [--compress CODEC] [--level N] [--dicts FILE]
+//                  [--train-dicts FILE] [--dict-bytes N] [--export-perfile DIR]
+//                  [--stats] [--rtt] [--key-cache FILE] <segment|dir>...
+//
+// --out             re-write the (re)decoded records as fresh segments
+// --compress        compress the records written by --out (none, lz4, zstd)
+// --level           zstd compression level (default 3)
+// --dicts           per-cmd dictionaries, to inflate and to compress with
+// --train-dicts     train per-cmd dictionaries on the payloads and save them
+// --dict-bytes      size of each trained dictionary (default 16384)
+// --export-perfile  write the legacy <idx>_<CS|SC>_<Name>.bin layout
+// --stats           print per-stage decode latency percentiles
+// --rtt             pair requests with responses and print per-cmd round trips
+// --key-cache       session key file written by the sniffer (key_cache_file)
+
+#include "CaptureReader.h"
+#include "CaptureWriter.h"
+#include "Compression.h"
+#include "Correlator.h"
+#include "KeyCache.h"
+#include "ProtoScan.h"
+#include "Telemetry.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static int Usage() {
+    std::fprintf(stderr, "usage: sniffer_replay [--out DIR] [--compress CODEC] [--level N] [--dicts FILE]\n"
+        "                      [--train-dicts FILE] [--dict-bytes N] [--export-perfile DIR]\n"
+        "                      [--stats] [--rtt] [--key-cache FILE] <segment|dir>...\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    fs::path outDir, exportDir, dictsFile, trainFile;
+    std::vector<fs::path> segments;
+    bool stats = false;
+    bool rtt = false;
+    CompressionOptions compression;
+    size_t dictBytes = 16 * 1024;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--out") && i + 1 < argc) outDir = argv[++i];
+        else if (!std::strcmp(argv[i], "--compress") && i + 1 < argc) {
+            if (!ParseCodec(argv[++i], compression.codec) || !CodecAvailable(compression.codec)) {
+                std::fprintf(stderr, "codec %s is not available\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (!std::strcmp(argv[i], "--level") && i + 1 < argc) compression.level = std::atoi(argv[++i]);
+        else if (!std::strcmp(argv[i], "--dicts") && i + 1 < argc) dictsFile = argv[++i];
+        else if (!std::strcmp(argv[i], "--train-dicts") && i + 1 < argc) trainFile = argv[++i];
+        else if (!std::strcmp(argv[i], "--dict-bytes") && i + 1 < argc) {
+            dictBytes = size_t(std::strtoull(argv[++i], nullptr, 10));
+            if (dictBytes < 256 || dictBytes > kLz4MaxDict) return Usage();
+        }
+        else if (!std::strcmp(argv[i], "--export-perfile") && i + 1 < argc) exportDir = argv[++i];
+        else if (!std::strcmp(argv[i], "--stats")) stats = true;
+        else if (!std::strcmp(argv[i], "--rtt")) rtt = true;
+        else if (!std::strcmp(argv[i], "--key-cache") && i + 1 < argc) GetKeyCache().Attach(argv[++i]);
+        else if (argv[i][0] == '-') return Usage();
+        else {
+            auto found = ListCaptureSegments(argv[i]);
+            segments.insert(segments.end(), found.begin(), found.end());
+        }
+    }
+    if (segments.empty()) return Usage();
+
+    DictionarySet dicts;
+    if (!dictsFile.empty()) {
+        if (!dicts.Load(dictsFile)) {
+            std::fprintf(stderr, "cannot read dictionaries %s\n", dictsFile.string().c_str());
+            return 1;
+        }
+        dicts.Prepare(compression.level);
+        compression.dicts = &dicts;
+    }
+    DictionaryTrainer trainer(dictBytes);
+
+    std::error_code ec;
+    CaptureWriter writer;
+    std::vector<uint8_t> scratch, indexScratch;
+    PacketBuffer packed;
+    uint64_t compressed = 0;
+    if (!outDir.empty()) {
+        fs::create_directories(outDir, ec);
+        if (!writer.Open(outDir, 0, 256ull << 20)) {
+            std::fprintf(stderr, "cannot create segments in %s\n", outDir.string().c_str());
+            return 1;
+        }
+    }
+    if (!exportDir.empty()) fs::create_directories(exportDir, ec);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    ReplaySource src(segments);
+    src.SetDictionaries(&dicts);
+    RecordView rv;
+    Correlator correlator;
+    uint64_t out = 0;
+    while (src.Next(rv)) {
+        ++out;
+        if (rtt) correlator.Observe(rv.hdr, rv.head, rv.peerSession);
+        if (!trainFile.empty()) trainer.Add(rv.hdr.cmdId, rv.payload, rv.hdr.payloadLen);
+        if (writer.IsOpen()) {
+            // Head and payload: the payload may have been inflated elsewhere.
+            scratch.resize(rv.hdr.RecordSize());
+            EncodeRecordHeader(scratch.data(), rv.hdr);
+            std::memcpy(scratch.data() + kRecordHeaderSize, rv.head, rv.hdr.headLen);
+            std::memcpy(scratch.data() + kRecordHeaderSize + rv.hdr.headLen, rv.payload, rv.hdr.payloadLen);
+            Platform::IoSlice record = { scratch.data(), scratch.size() };
+            if (compression.codec != Codec::None && CompressRecord(scratch.data(), compression, packed)) {
+                record = { packed.data(), packed.size() };
+                ++compressed;
+            }
+            if (rv.fieldIndex) {
+                // Keep the stored field index in front of its record.
+                RecordHeader ih = rv.hdr;
+                ih.flags = kRecordFieldIndex;
+                ih.headLen = 0;
+                ih.payloadLen = uint32_t(rv.fieldCount * kProtoFieldSize);
+                indexScratch.resize(ih.RecordSize());
+                EncodeRecordHeader(indexScratch.data(), ih);
+                std::memcpy(indexScratch.data() + kRecordHeaderSize, rv.fieldIndex, ih.payloadLen);
+                const Platform::IoSlice pair[2] = { { indexScratch.data(), indexScratch.size() }, record };
+                writer.AppendBatch(pair, 2);
+            }
+            else {
+                writer.AppendBatch(&record, 1);
+            }
+        }
+        if (!exportDir.empty()) WriteLegacyPacketFile(exportDir, rv.hdr, rv.payload);
+    }
+    writer.Close();
+    if (!trainFile.empty()) {
+        DictionarySet trained;
+        trainer.Build(trained);
+        if (!trained.Save(trainFile)) {
+            std::fprintf(stderr, "cannot write dictionaries %s\n", trainFile.string().c_str());
+            return 1;
+        }
+        std::printf("dictionaries: %zu written to %s\n", trained.Size(), trainFile.string().c_str());
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    const ReplayStats& st = src.Stats();
+    std::printf("segments:   %zu (%llu truncated)\n", segments.size(), (unsigned long long)st.truncatedSegments);
+    std::printf("records:    %llu read, %llu raw, %llu field indexes, %llu decoded, %llu bad frames\n",
+        (unsigned long long)st.records, (unsigned long long)st.rawRecords, (unsigned long long)st.indexRecords,
+        (unsigned long long)st.decoded, (unsigned long long)st.frameErrors);
+    std::printf("packets:    %llu\n", (unsigned long long)out);
+    if (st.compressedRecords || compressed)
+        std::printf("compressed: %llu read (%llu not inflated), %llu written\n",
+            (unsigned long long)st.compressedRecords, (unsigned long long)st.inflateErrors,
+            (unsigned long long)compressed);
+    std::printf("throughput: %.1f MB in %.3f s (%.1f MB/s)\n",
+        st.bytes / 1e6, secs, secs > 0 ? st.bytes / 1e6 / secs : 0.0);
+    if (stats) Telemetry::Report(stdout);
+    if (rtt) correlator.Report(stdout);
+    return 0;
+}